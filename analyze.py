@@ -55,6 +55,15 @@ def binned_hist(hist: dict | defaultdict, width: int = 5) -> dict | defaultdict:
 
 	return binned
 
+def board_digits(board: int | str) -> int:
+	"hex digits in a state. `board` is the side length, or \"WxH\" for a `cens` torus"
+
+	if isinstance(board, str):
+		w, h = map(int, board.split("x"))
+		return (w*h + 3) // 4
+
+	return board**2 // 4
+
 def summarize(
 	dataset: dict[str, dict | int],
 	bin_width: int = 10,           # linear binning for the transients
@@ -119,25 +128,58 @@ def summarize(
 	nxt_trials   = dataset["trials"][0] # number of regular trials
 	pdr_trials   = dataset["trials"][1] # number of predecessor count trials.
 	indegrees = dataset["indegrees"]
+	weighted  = dataset.get("weighted", False) # from `nrun strat`. the counts aren't trials
+
+	digits = board_digits(dataset.get("board", 8)) # hex digits in a state
 
 	print("Summary:")
 
+	if dataset.get("ruleset") is not None:
+		print(f"# ruleset: {dataset["ruleset"]}")
+
+	if dataset.get("board", 8) != 8:
+		board = dataset["board"]
+		print(f"# board: {board if isinstance(board, str) else f"{board}x{board}"}")
+
+	if dataset.get("neighborhood", "MOORE") != "MOORE":
+		print(f"# neighborhood: {dataset["neighborhood"]}")
+
+	if weighted:
+		print("# weighted: the histograms are estimates of that many trials, so there are no binomial intervals")
+
 	print(f"# total trials: nxt={nxt_trials:,}   pdr={pdr_trials:,}")
 
 	print(
 		f"# hcollide: " + \
 		f"{{\"count\": {hcollide["count"]}, " + \
-		f"\"states\": [{ ', '.join(f"0x{x:016x}" for x in hcollide["states"]) }]}}"
+		f"\"states\": [{ ', '.join(f"0x{x:0{digits}x}" for x in hcollide["states"]) }]}}"
 	)
 
 	print("# counts:")
 	for k, v in counts.items():
 		print(f"    {k}: {v:,} ({v/nxt_trials*100}%)")
 
-	if alpha != 0.05:
-		z_tmp: float = 1.959963984540054 # norm.ppf(0.975)
+	# the binomial intervals are only right for counts of trials.
+	if not weighted:
+		if alpha != 0.05:
+			z_tmp: float = 1.959963984540054 # norm.ppf(0.975)
+
+			print(f"# 95% confidence intervals (alpha=0.05, z=1.96):")
+			for k, v in counts.items():
+				p = v / nxt_trials
+
+				se = sqrt(p * (1 - p) / nxt_trials)
+				p_min, p_max = p - z_tmp * se, p + z_tmp * se
+
+				print(f"    {k}: ({p_min*100}%, {p_max*100}%), SE={se}")
+			else:
+				assert p == counts["cycle"] / nxt_trials, "`cycle` didn't run last"
+				p_min += 1 - 2*p
+				p_max += 1 - 2*p
+
+				print(f"   static: ({p_min*100}%, {p_max*100}%), SE={se}")
 
-		print(f"# 95% confidence intervals (alpha=0.05, z=1.96):")
+		print(f"# {round((1 - alpha)*100, 2)}% confidence intervals (alpha={alpha}, z={z}):")
 		for k, v in counts.items():
 			p = v / nxt_trials
 
@@ -147,27 +189,12 @@ def summarize(
 			print(f"    {k}: ({p_min*100}%, {p_max*100}%), SE={se}")
 		else:
 			assert p == counts["cycle"] / nxt_trials, "`cycle` didn't run last"
+			# these values are only right if "cycle" was the last item in "counts".
+			# because p here is 1 - p there.
 			p_min += 1 - 2*p
 			p_max += 1 - 2*p
 
-			print(f"   static: ({p_min*100}%, {p_max*100}%), SE={se}")
-
-	print(f"# {round((1 - alpha)*100, 2)}% confidence intervals (alpha={alpha}, z={z}):")
-	for k, v in counts.items():
-		p = v / nxt_trials
-
-		se = sqrt(p * (1 - p) / nxt_trials)
-		p_min, p_max = p - z_tmp * se, p + z_tmp * se
-
-		print(f"    {k}: ({p_min*100}%, {p_max*100}%), SE={se}")
-	else:
-		assert p == counts["cycle"] / nxt_trials, "`cycle` didn't run last"
-		# these values are only right if "cycle" was the last item in "counts".
-		# because p here is 1 - p there.
-		p_min += 1 - 2*p
-		p_max += 1 - 2*p
-
-		print(f"   static: ({p_min*100}%, {p_max*100:}%), SE={se}")
+			print(f"   static: ({p_min*100}%, {p_max*100:}%), SE={se}")
 
 	print("# periods:")
 	for k, v in sorted(periods.items()):
@@ -210,8 +237,9 @@ def summarize(
 		print("# indegree modes:")
 		_rank_modes(indegrees, pdr_trials)
 
-	E = lambda D, T: sum(val * cnt for val, cnt in D.items()) / T
-	V = lambda D, T: sum(val**2 * cnt for val, cnt in D.items()) / T - E(D,T)**2
+	# a ruleset can have only one kind of trial, so T can be zero.
+	E = lambda D, T: sum(val * cnt for val, cnt in D.items()) / T if T else 0.0
+	V = lambda D, T: sum(val**2 * cnt for val, cnt in D.items()) / T - E(D,T)**2 if T else 0.0
 
 	print(
 		f"# E[x]:",
@@ -237,17 +265,36 @@ def summarize(
 
 	print(
 		f"# max:",
-		f"    periods   : {max(periods.keys())}",
-		f"    transients: {max(transients.keys())}",
-		f"    indegrees : {max(indegrees.keys())}",
+		f"    periods   : {max(periods.keys(), default=0)}",
+		f"    transients: {max(transients.keys(), default=0)}",
+		f"    indegrees : {max(indegrees.keys(), default=0)}",
 		sep = '\n'
 	)
 
 	# TODO: print more stuff about the indegree count statistics
 
+def union_ranges(ranges: list[list[int]]) -> list[list[int]]:
+	"the [first, count] trial ranges of one seed, sorted, with the ones that overlap or touch merged"
+
+	union = []
+
+	for first, count in sorted(ranges):
+		if count == 0:
+			continue
+
+		if union and first <= union[-1][0] + union[-1][1]:
+			union[-1][1] = max(union[-1][1], first + count - union[-1][0])
+		else:
+			union.append([first, count])
+
+	return union
+
 def combine_datasets(*datasets) -> dict:
+	"all the datasets are assumed to have the same ruleset, board size, neighborhood, and weighting"
+
 	if len(datasets) == 0:
 		return {
+			"ruleset": None,
 			"hcollide": {"count": 0, "states": [0]},
 			"trials": [0, 0],
 			"counts": defaultdict(int, {"empty": 0, "const": 0, "cycle": 0}),
@@ -261,6 +308,11 @@ def combine_datasets(*datasets) -> dict:
 	periods    = defaultdict(int)
 	transients = defaultdict(int)
 	indegrees  = defaultdict(int)
+	# only from CYCLE_SYMMETRY builds
+	symmetries    = defaultdict(int)
+	displacements = defaultdict(int)
+	# the trial ranges of each seed, from COUNTER_RAND builds
+	ranges = defaultdict(list)
 
 	for dataset in datasets:
 		if dataset["hcollide"]["count"] > hcollide["count"]:
@@ -284,13 +336,26 @@ def combine_datasets(*datasets) -> dict:
 		for key, val in dataset["indegrees"].items():
 			indegrees[key] += val
 
+		for key, val in dataset.get("symmetries", {}).items():
+			symmetries[key] += val
+
+		for key, val in dataset.get("displacements", {}).items():
+			displacements[key] += val
+
+		for seed, val in dataset.get("ranges", {}).items():
+			ranges[seed].extend(val)
+
 	hcollide["states"] = list(hcollide["states"])
 
 	# reorder the keys to be ascending instead of based on which was added first.
 	periods    = {key: periods[key] for key in sorted(periods.keys())}
 	transients = {key: transients[key] for key in sorted(transients.keys())}
 
-	return {
+	combined = {
+		"ruleset"   : datasets[0].get("ruleset"),
+		"board"     : datasets[0].get("board", 8),
+		"neighborhood": datasets[0].get("neighborhood", "MOORE"),
+		"weighted"  : datasets[0].get("weighted", False),
 		"hcollide"  : hcollide,
 		"trials"    : trials,
 		"counts"    : counts,
@@ -299,7 +364,24 @@ def combine_datasets(*datasets) -> dict:
 		"indegrees" : indegrees,
 	}
 
-def dataset_from_json(path: str = "data.json") -> tuple[dict, int]:
+	if symmetries:
+		combined["symmetries"]    = dict(symmetries)
+		combined["displacements"] = dict(displacements)
+
+	if ranges:
+		combined["ranges"] = {seed: union_ranges(val) for seed, val in ranges.items()}
+
+	return combined
+
+def datasets_from_json(path: str = "data.json") -> tuple[dict[tuple[str | None, int, str, bool], dict], int]:
+	"""
+	combines the objects in the data file separately for each ruleset, board size,
+	neighborhood, and weighting. objects from before the ruleset was recorded have the
+	ruleset None, objects without a board size are 8x8, objects without a neighborhood are
+	MOORE, and objects without "weighted" (from `nrun strat`) are counts of trials.
+	the trial ranges end up in dataset["ranges"], a dictionary of them for each seed.
+	"""
+
 	with open(path) as f:
 		data = json_load(f)
 
@@ -311,31 +393,65 @@ def dataset_from_json(path: str = "data.json") -> tuple[dict, int]:
 		x["transients"] = defaultdict(int, {int(k): v for k, v in x["transients"].items()})
 		x["indegrees"]  = defaultdict(int, {int(k): v for k, v in x["indegrees"].items()})
 
-	return combine_datasets(*data), len(data)
+		# one seed from life.c, or a dictionary of them from an object that was combined.
+		if "seed" in x:
+			x["ranges"] = {int(x.pop("seed")): x.get("ranges", [])}
+
+		if "ranges" in x:
+			x["ranges"] = {int(seed): [[int(a), int(b)] for a, b in val] for seed, val in x["ranges"].items()}
+
+	rulesets = defaultdict(list)
+
+	for x in data:
+		rulesets[x.get("ruleset"), x.get("board", 8), x.get("neighborhood", "MOORE"), x.get("weighted", False)].append(x)
+
+	return {k: combine_datasets(*v) for k, v in rulesets.items()}, len(data)
+
+def json_from_dataset(dataset: dict) -> str:
+	"a single object of the data file array"
 
-def json_from_dataset(dataset: dict) -> None:
 	hcollide = dataset["hcollide"].copy()
-	hcollide["states"] = [f"0x{s:016x}" for s in hcollide["states"]]
+	digits = board_digits(dataset.get("board", 8))
+	hcollide["states"] = [f"0x{s:0{digits}x}" for s in hcollide["states"]]
 	trials = dataset["trials"]
 	counts = {k: f"{v:,}" for k, v in dataset["counts"].items()}
+	ruleset = dataset.get("ruleset")
+	board = dataset.get("board", 8)
+	neighborhood = dataset.get("neighborhood", "MOORE")
+	# the same as life.c for a single seed, and a dictionary of them keyed by seed otherwise.
+	ranges = {seed: [[f"{a}", f"{b}"] for a, b in val] for seed, val in dataset.get("ranges", {}).items()}
+	seeds = f"\n\t\"seed\": \"{next(iter(ranges))}\",\n\t\"ranges\": {json_dumps(next(iter(ranges.values())))}," \
+		if len(ranges) == 1 else \
+		f"\n\t\"ranges\": {json_dumps({str(k): v for k, v in ranges.items()})}," if ranges else ""
 	# the keys of the periods and transients attributes get turned to strings by json.dumps
 
-	return "["                                                      + \
-		f"\n{{"                                                     + \
+	return f"{{"                                                    + \
+		(f"\n\t\"ruleset\": \"{ruleset}\"," if ruleset is not None else "") + \
+		(f"\n\t\"board\": {json_dumps(board)}," if board != 8 else "")      + \
+		(f"\n\t\"neighborhood\": \"{neighborhood}\"," if neighborhood != "MOORE" else "") + \
+		("\n\t\"weighted\": true," if dataset.get("weighted", False) else "") + \
+		seeds                                                       + \
 		f"\n\t\"hcollide\": {json_dumps(hcollide)},"                + \
 		f"\n\t\"trials\": [\"{trials[0]:,}\", \"{trials[1]:,}\"],"  + \
 		f"\n\t\"counts\": {json_dumps(counts)},"                    + \
 		f"\n\t\"periods\": {json_dumps(dataset["periods"])},"       + \
 		f"\n\t\"transients\": {json_dumps(dataset["transients"])}," + \
+		(f"\n\t\"symmetries\": {json_dumps(dataset["symmetries"])}," if "symmetries" in dataset else "") + \
+		(f"\n\t\"displacements\": {json_dumps(dataset["displacements"])}," if "displacements" in dataset else "") + \
 		f"\n\t\"indegrees\": {json_dumps(dataset["indegrees"])}"    + \
-		f"\n}}"                                                     + \
-		f"\n]\n"
+		f"\n}}"
+
+def json_from_datasets(datasets: dict[tuple[str | None, int, str, bool], dict]) -> str:
+	"the whole data file, with one object for each ruleset, board size, neighborhood, and weighting"
+
+	return "[\n" + ",\n".join(json_from_dataset(x) for x in datasets.values()) + "\n]\n"
 
 def fold_datafile(path: str | None = None, ret: str = "json") -> tuple[str | dict, int] | None:
 	"""
 	data file defaults to "data.json".
-	folds the data array into a single element.
+	folds the data array into a single element for each ruleset.
 	if the current data file only has one element, it doesn't rewrite to the file.
+	with ret="dataset", the datasets are returned in a dictionary keyed by (ruleset, board size, neighborhood, weighted).
 	"""
 
 	if path is None:
@@ -344,12 +460,12 @@ def fold_datafile(path: str | None = None, ret: str = "json") -> tuple[str | dic
 	if ret not in {"none", "json", "dataset"}:
 		raise ValueError("ret must be one of 'none', 'json', 'dataset'")
 
-	dataset, length = dataset_from_json(path)
+	dataset, length = datasets_from_json(path)
 
 	if length == 1 and ret == "none":
 		return None
 
-	jdata = json_from_dataset(dataset)
+	jdata = json_from_datasets(dataset)
 
 	if length == 1:
 		return (jdata if ret == "json" else dataset), length
@@ -378,10 +494,16 @@ def merge_datafiles(paths: list[str] | None = None, delete_old: bool = False, re
 
 		return fold_datafile(paths[0], ret=ret)
 
-	data    = tuple(zip( *(dataset_from_json(path) for path in paths) ))
-	dataset = combine_datasets(*data[0])
+	data     = tuple(zip( *(datasets_from_json(path) for path in paths) ))
+	rulesets = defaultdict(list)
+
+	for datasets in data[0]:
+		for key, val in datasets.items():
+			rulesets[key].append(val)
+
+	dataset = {key: combine_datasets(*val) for key, val in rulesets.items()}
 	length  = sum(data[1])
-	jdata   = json_from_dataset(dataset)
+	jdata   = json_from_datasets(dataset)
 
 	# NOTE: this is safe because the default array is only one file,
 	#       so this code never runs, and the list is never mutated.
@@ -399,10 +521,10 @@ def merge_datafiles(paths: list[str] | None = None, delete_old: bool = False, re
 	if ret != "none":
 		return (jdata if ret == "json" else dataset), length
 
-show_new = lambda path: summarize(
-	fold_datafile(path, ret="dataset")[0],
-	bin_width=10, z=8, rare=1e-4, super_rare=1e-6
-)
+show_new = lambda path: [
+	summarize(dataset, bin_width=10, z=8, rare=1e-4, super_rare=1e-6)
+	for dataset in fold_datafile(path, ret="dataset")[0].values()
+]
 
 if __name__ == "__main__":
 	from sys import argv
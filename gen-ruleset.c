@@ -0,0 +1,588 @@
+// compiles a B/S ruleset into the NEXT_COND expression that matx8-next.h uses.
+// compile with `gcc -O2 gen-ruleset.c -o gen-ruleset.exe` (the Makefile does this).
+
+// the condition is a function of 4 bits (s, n2, n1, n0), since 8 neighbors wraps
+// around to 0, so the truth table only has 16 entries. that is small enough to try
+// every formula in order of size, so the output is the smallest formula there is. it is a
+// tree, so a subexpression that shows up twice is counted twice, and a circuit that shares
+// it (which GCC might make out of it anyway) could be smaller. with -t it only tries a few
+// shapes of 3-input nodes, so it isn't always the smallest there either.
+// it gets evaluated on every generation of every trial, so every operation counts.
+
+// a truth table here is 16 bits, where bit i is the output for s = i >> 3 & 1,
+// n2 = i >> 2 & 1, n1 = i >> 1 & 1, and n0 = i & 1. this is the same order that
+// the old SymPy version used for the minterms.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+
+#define TT_N0	0xAAAAu
+#define TT_N1	0xCCCCu
+#define TT_N2	0xF0F0u
+#define TT_S	0xFF00u
+
+#define MAX_COST 24
+#define NO_COST  0xFF
+
+#define MATCHES(tt, target, care) ((((tt) ^ (target)) & (care)) == 0)
+
+enum { OP_VAR, OP_NOT, OP_AND, OP_OR, OP_XOR, OP_ANDN };
+
+// the formulas found so far, indexed by their truth table.
+typedef struct {
+	u8  cost[1 << 16]; // number of operations. NO_COST if it hasn't been found.
+	u8  op  [1 << 16];
+	u16 lhs [1 << 16]; // for OP_VAR, this is the variable index instead.
+	u16 rhs [1 << 16];
+
+	u16 *levels[MAX_COST + 1]; // the truth tables of each cost, in the order found
+	u32 level_len[MAX_COST + 1];
+	u8  done;                  // number of levels that are complete
+	u32 found;                 // number of truth tables that have a formula
+	u32 total;                 // number of truth tables there are
+	bool andn;                 // `a & ~b` counts as one operation (ANDN, PANDN)
+} Formulas;
+
+static const u16 var_tts[4] = {TT_N0, TT_N1, TT_N2, TT_S};
+static const char *const var_names[4] = {"n0", "n1", "n2", "s"};
+
+static void Formulas_init(Formulas *const restrict this, const u8 nvars, const bool andn) {
+	// the variables are the first `nvars` of n0, n1, n2, s.
+	memset(this->cost, NO_COST, sizeof this->cost);
+	this->done  = 1;
+	this->found = nvars;
+	this->total = 1u << (1 << nvars);
+	this->andn  = andn;
+
+	for (u8 i = 0; i <= MAX_COST; i++) {
+		if (this->levels[i] == NULL) {
+			this->levels[i] = malloc((1 << 16) * sizeof(u16));
+
+			if (this->levels[i] == NULL) {
+				fputs("Out of Memory.\n", stderr);
+				exit(2);
+			}
+		}
+
+		this->level_len[i] = 0;
+	}
+
+	for (u8 i = 0; i < nvars; i++) {
+		const u16 tt = var_tts[i];
+
+		this->cost[tt] = 0;
+		this->op[tt]   = OP_VAR;
+		this->lhs[tt]  = i;
+		this->levels[0][this->level_len[0]++] = tt;
+	}
+}
+
+static inline void _Formulas_add(Formulas *const restrict this, const u8 k, const u16 tt, const u8 op, const u16 lhs, const u16 rhs) {
+	if (this->cost[tt] != NO_COST)
+		return;
+
+	this->cost[tt] = k;
+	this->op[tt]   = op;
+	this->lhs[tt]  = lhs;
+	this->rhs[tt]  = rhs;
+	this->levels[k][this->level_len[k]++] = tt;
+	this->found++;
+}
+
+static bool _Formulas_level(Formulas *const restrict this) {
+	// finds every formula with the next cost. returns false if there is nothing left.
+	if (this->done > MAX_COST || this->found == this->total)
+		return false;
+
+	const u8 k = this->done++;
+
+	for (u32 i = 0; i < this->level_len[k - 1]; i++) {
+		const u16 f = this->levels[k - 1][i];
+		_Formulas_add(this, k, ~f, OP_NOT, f, 0);
+	}
+
+	// the two operands have k - 1 operations in total.
+	for (u8 a = 0; a <= (k - 1) / 2; a++) {
+		const u8 b = k - 1 - a;
+
+		for (u32 i = 0; i < this->level_len[a]; i++) {
+			const u16 f = this->levels[a][i];
+
+			for (u32 j = a == b ? i + 1 : 0; j < this->level_len[b]; j++) {
+				const u16 g = this->levels[b][j];
+
+				_Formulas_add(this, k, f & g, OP_AND, f, g);
+				_Formulas_add(this, k, f | g, OP_OR , f, g);
+				_Formulas_add(this, k, f ^ g, OP_XOR, f, g);
+
+				if (this->andn) {
+					_Formulas_add(this, k, f & ~g, OP_ANDN, f, g);
+					_Formulas_add(this, k, g & ~f, OP_ANDN, g, f);
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+static int Formulas_search(Formulas *const restrict this, const u16 target, const u16 care) {
+	// finds the smallest formula that matches `target` wherever `care` is set.
+	// returns its truth table, or -1 if there isn't one within MAX_COST operations.
+	for (u8 k = 0; ; k++) {
+		if (k == this->done && !_Formulas_level(this))
+			return -1;
+
+		for (u32 i = 0; i < this->level_len[k]; i++)
+			if (MATCHES(this->levels[k][i], target, care))
+				return this->levels[k][i];
+	}
+}
+
+static u8 prec(const u8 op) {
+	// operator precedence in C
+	switch (op) {
+	case OP_OR:   return 1;
+	case OP_XOR:  return 2;
+	case OP_AND:  return 3;
+	case OP_ANDN: return 3;
+	case OP_NOT:  return 4;
+	default:      return 5;
+	}
+}
+
+static char *Formulas_print(
+	const Formulas *const restrict this,
+	char *restrict out,
+	const u16 tt,
+	const u8 parent_prec,
+	const char *const names[]
+) {
+	// writes the formula for `tt` to `out` and returns the new end. `names` are the
+	// strings for the variables. the ones with spaces get put in parentheses.
+	const u8 op = this->op[tt];
+	const bool paren = prec(op) < parent_prec;
+
+	if (op == OP_VAR) {
+		const char *const name = names[this->lhs[tt]];
+		return out + sprintf(out, strchr(name, ' ') != NULL ? "(%s)" : "%s", name);
+	}
+
+	if (paren)
+		*out++ = '(';
+
+	switch (op) {
+	case OP_NOT:
+		*out++ = '~';
+		out = Formulas_print(this, out, this->lhs[tt], prec(OP_NOT), names);
+		break;
+	case OP_ANDN:
+		out = Formulas_print(this, out, this->lhs[tt], prec(OP_AND), names);
+		out += sprintf(out, " & ~");
+		out = Formulas_print(this, out, this->rhs[tt], prec(OP_NOT), names);
+		break;
+	default: {
+		// the bigger operand goes first, so it reads like `~n2 & n1 & (n0 | s)`.
+		u16 lhs = this->lhs[tt], rhs = this->rhs[tt];
+
+		if (this->cost[lhs] > this->cost[rhs] || this->cost[lhs] == this->cost[rhs] && lhs > rhs) {
+			const u16 tmp = lhs;
+			lhs = rhs;
+			rhs = tmp;
+		}
+
+		out = Formulas_print(this, out, lhs, prec(op), names);
+		out += sprintf(out, "%s", op == OP_AND ? " & " : op == OP_OR ? " | " : " ^ ");
+		out = Formulas_print(this, out, rhs, prec(op), names);
+	}
+	}
+
+	if (paren)
+		*out++ = ')';
+
+	*out = '\0';
+	return out;
+}
+
+//////////////////////////// ternary logic form ////////////////////////////
+
+// VPTERNLOG evaluates any function of 3 inputs in one instruction, and GCC merges
+// subexpressions with only 3 distinct inputs into one. so with AVX-512, the thing to
+// minimize is the number of 3-input nodes, and then the operations inside of them.
+// 3 nodes are always enough: s ? f(n2, n1, n0) : g(n2, n1, n0).
+
+// in this section, a node function is 8 bits, where bit i is the output for
+// inputs (i >> 2 & 1, i >> 1 & 1, i & 1), and the inputs are 16-bit truth tables.
+
+static Formulas f3; // every function of n0, n1, and n2, with each byte the same.
+
+// best3[mask << 8 | value] is the cheapest node function that matches `value`
+// wherever `mask` is set. the value bits outside of `mask` have to be 0.
+static u8 best3[1 << 16];
+
+static inline u8 cost3(const u8 fn) {
+	return f3.cost[fn | fn << 8];
+}
+
+
+static void ternary_init(const bool andn) {
+	static bool seen[1 << 16];
+
+	Formulas_init(&f3, 3, andn);
+
+	while (_Formulas_level(&f3));
+
+	for (u32 mask = 0; mask < 256; mask++) {
+		for (u32 fn = 0; fn < 256; fn++) {
+			const u32 i = mask << 8 | (fn & mask);
+
+			if (!seen[i] || cost3(fn) < cost3(best3[i])) {
+				best3[i] = fn;
+				seen[i]  = true;
+			}
+		}
+	}
+}
+
+static int node_fn(const u16 x, const u16 y, const u16 z, const u16 target, const u16 care) {
+	// the cheapest node function of (z, y, x) that matches `target` wherever `care`
+	// is set, or -1 if two of those places have the same inputs and different outputs.
+	u8 mask = 0, value = 0;
+
+	for (u8 i = 0; i < 16; i++) {
+		if (!(care >> i & 1))
+			continue;
+
+		const u8 key = (z >> i & 1) << 2 | (y >> i & 1) << 1 | (x >> i & 1);
+		const u8 bit = target >> i & 1;
+
+		if (mask >> key & 1) {
+			if ((value >> key & 1) != bit)
+				return -1;
+		}
+		else {
+			mask  |= 1 << key;
+			value |= bit << key;
+		}
+	}
+
+	return best3[mask << 8 | value];
+}
+
+static u16 node_tt(const u8 fn, const u16 x, const u16 y, const u16 z) {
+	u16 tt = 0;
+
+	for (u8 i = 0; i < 16; i++)
+		tt |= (fn >> ((z >> i & 1) << 2 | (y >> i & 1) << 1 | (x >> i & 1)) & 1) << i;
+
+	return tt;
+}
+
+// a node whose inputs are all variables. `skip` is the variable it doesn't use.
+typedef struct {
+	u16 tt;
+	u8  fn;
+	u8  skip;
+} Leaf;
+
+static char *Leaf_print(const Leaf *const restrict this, char *const restrict out) {
+	const char *names[3];
+
+	for (u8 i = 0, j = 0; i < 4; i++)
+		if (i != this->skip)
+			names[j++] = var_names[i];
+
+	Formulas_print(&f3, out, this->fn | this->fn << 8, 0, names);
+	return out;
+}
+
+static u8 ternary_search(char *restrict out, const u16 target, const u16 care) {
+	// writes the expression with the fewest nodes, and then the fewest operations
+	// inside of them, and returns the number of nodes. with 3 nodes, it only tries
+	// f(x, g(...), h(...)), not chains like f(x, y, g(z, w, h(...))).
+	static Leaf leaves[4 * 256];
+	static u16 leaf_of[1 << 16]; // index + 1 into `leaves` for each truth table
+	u32 nleaves = 0;
+
+	for (u8 i = 0; i < 4; i++) {
+		if (MATCHES(var_tts[i], target, care)) {
+			strcpy(out, var_names[i]);
+			return 0;
+		}
+	}
+
+	memset(leaf_of, 0, sizeof leaf_of);
+
+	for (u8 skip = 4; skip-- > 0;) {
+		u16 v[3];
+
+		for (u8 i = 0, j = 0; i < 4; i++)
+			if (i != skip)
+				v[j++] = var_tts[i];
+
+		for (u32 fn = 0; fn < 256; fn++) {
+			const Leaf leaf = {node_tt(fn, v[0], v[1], v[2]), fn, skip};
+			u16 *const index = leaf_of + leaf.tt;
+
+			if (*index == 0) {
+				leaves[nleaves] = leaf;
+				*index = ++nleaves;
+			}
+			else if (cost3(fn) < cost3(leaves[*index - 1].fn))
+				leaves[*index - 1] = leaf;
+		}
+	}
+
+	// 1 node
+	const Leaf *best_leaf = NULL;
+
+	for (u32 i = 0; i < nleaves; i++)
+		if (MATCHES(leaves[i].tt, target, care))
+			if (best_leaf == NULL || cost3(leaves[i].fn) < cost3(best_leaf->fn))
+				best_leaf = leaves + i;
+
+	if (best_leaf != NULL) {
+		Leaf_print(best_leaf, out);
+		return 1;
+	}
+
+	// 2 nodes: f(x, y, leaf)
+	u32 best_cost = UINT32_MAX;
+	u8 best_fn = 0, best_x = 0, best_y = 0;
+	const Leaf *best_g = NULL, *best_h = NULL;
+
+	for (u32 i = 0; i < nleaves; i++) {
+		const Leaf *const g = leaves + i;
+
+		for (u8 x = 0; x < 4; x++) {
+			for (u8 y = x + 1; y < 4; y++) {
+				const int fn = node_fn(var_tts[x], var_tts[y], g->tt, target, care);
+
+				if (fn >= 0 && (u32) cost3(fn) + cost3(g->fn) < best_cost) {
+					best_cost = cost3(fn) + cost3(g->fn);
+					best_fn   = fn;
+					best_x    = x;
+					best_y    = y;
+					best_g    = g;
+				}
+			}
+		}
+	}
+
+	if (best_g != NULL) {
+		char inner[256];
+		const char *const names[3] = {var_names[best_x], var_names[best_y], Leaf_print(best_g, inner)};
+
+		Formulas_print(&f3, out, best_fn | best_fn << 8, 0, names);
+		return 2;
+	}
+
+	// 3 nodes: f(x, leaf, leaf). this always works with x = s.
+	for (u32 i = 0; i < nleaves; i++) {
+		const Leaf *const g = leaves + i;
+
+		for (u32 j = i + 1; j < nleaves; j++) {
+			const Leaf *const h = leaves + j;
+			const u32 inner_cost = cost3(g->fn) + cost3(h->fn);
+
+			if (inner_cost >= best_cost)
+				continue;
+
+			for (u8 x = 0; x < 4; x++) {
+				const int fn = node_fn(var_tts[x], g->tt, h->tt, target, care);
+
+				if (fn >= 0 && inner_cost + cost3(fn) < best_cost) {
+					best_cost = inner_cost + cost3(fn);
+					best_fn   = fn;
+					best_x    = x;
+					best_g    = g;
+					best_h    = h;
+				}
+			}
+		}
+	}
+
+	char inner[2][256];
+	const char *const names[3] = {var_names[best_x], Leaf_print(best_g, inner[0]), Leaf_print(best_h, inner[1])};
+
+	Formulas_print(&f3, out, best_fn | best_fn << 8, 0, names);
+	return 3;
+}
+
+//////////////////////////////// rulesets ////////////////////////////////
+
+static u16 str2tt(const char *restrict str) {
+	// `B.../S...` in either order. returns s << 8 | b, where bit n of each half is
+	// for n neighbors. 8 neighbors is the same as 0, so they have to be given together.
+	const char *digits[2] = {NULL, NULL}; // birth, survival
+	u8 lens[2] = {0, 0};
+
+	for (u8 half = 0; half < 2; half++) {
+		const char c = *str | 0x20; // lowercase
+		const u8 part = c == 's';
+
+		if (c != 'b' && c != 's') {
+			fprintf(stderr, "unknown character in the %s half of the input\n", half ? "second" : "first");
+			exit(1);
+		}
+
+		if (digits[part] != NULL) {
+			fputs("input had two 'B's or two 'S's\n", stderr);
+			exit(1);
+		}
+
+		digits[part] = ++str;
+
+		while (*str != '/' && *str != '\0')
+			str++;
+
+		lens[part] = str - digits[part];
+
+		if (half == 0 && *str++ != '/') {
+			fputs("input has to have a '/'\n", stderr);
+			exit(1);
+		}
+	}
+
+	if (*str != '\0') {
+		fputs("input had more than one '/'\n", stderr);
+		exit(1);
+	}
+
+	u16 tt = 0;
+
+	for (u8 part = 0; part < 2; part++) {
+		bool has0 = false, has8 = false;
+
+		for (u8 i = 0; i < lens[part]; i++) {
+			const char c = digits[part][i];
+
+			if (c < '0' || c > '8') {
+				fputs("string contained digits higher than 8\n", stderr);
+				exit(1);
+			}
+
+			has0 |= c == '0';
+			has8 |= c == '8';
+			tt |= 1u << (part << 3 | (c - '0' & 7));
+		}
+
+		if (has0 != has8) {
+			fprintf(stderr, "%c present in %s cases without a%s\n", has0 ? '0' : '8',
+				part ? "survive" : "birth", has0 ? "n 8" : " 0");
+			exit(1);
+		}
+	}
+
+	return tt;
+}
+
+static void print_bin(const u32 x, const u8 width) {
+	putchar('0');
+	putchar('b');
+
+	for (u8 i = width; i-- > 0;)
+		putchar('0' + (x >> i & 1));
+
+	putchar('\n');
+}
+
+static void help(void) {
+	puts(
+		"usage: gen-ruleset [-a] [-t] [-4] RULESET\n"
+		"       gen-ruleset (-b | -s | -tt1 | -tt2) RULESET\n"
+		"example: `./gen-ruleset.exe \"B347/S0238\"`\n"
+		"\n"
+		"prints the smallest C formula of n2, n1, n0, and s for the ruleset.\n"
+		"\n"
+		"-a    count `a & ~b` as one operation (ANDN on BMI1, PANDN for SIMD).\n"
+		"-t    minimize the number of 3-input nodes first (VPTERNLOG on AVX-512).\n"
+		"-4    neighbor counts 5 to 7 can't happen (von Neumann and diagonal).\n"
+		"\n"
+		"use '-b' before the ruleset to print the B truth table.\n"
+		"use '-s' for the S truth table, and '-tt1' or '-tt2' for both.\n"
+		"'-tt1' gives a single truth table, and '-tt2' gives each separately."
+	);
+}
+
+int main(int argc, char **argv) {
+	bool andn = false, ternary = false, four = false;
+
+	argc--, argv++; // ignore the path to this file
+
+	for (; argc != 0 && argv[0][0] == '-' && argv[0][1] != '\0' && argv[0][2] == '\0'; argc--, argv++) {
+		switch (argv[0][1]) {
+		case 'a': andn    = true; continue;
+		case 't': ternary = true; continue;
+		case '4': four    = true; continue;
+		}
+
+		break;
+	}
+
+	if (argc == 0 || !strcmp(*argv, "-h") || !strcmp(*argv, "-?") || !strcmp(*argv, "-help") || !strcmp(*argv, "--help")) {
+		help();
+		return argc == 0;
+	}
+
+	const char *const flag = *argv;
+
+	if (!strcmp(flag, "-b") || !strcmp(flag, "-s") || !strcmp(flag, "-tt1") || !strcmp(flag, "-tt2")) {
+		if (argc == 1) {
+			printf("flag '%s' given without a ruleset\n", flag);
+			return 1;
+		}
+
+		if (argc > 2)
+			fputs("arguments after the second are ignored.\n", stderr);
+
+		// 9-bit tables, with bit 8 the same as bit 0.
+		const u16 tt = str2tt(argv[1]);
+		const u16 b = (tt & 1) << 8 | (tt & 255);
+		const u16 s = (tt >> 8 & 1) << 8 | tt >> 8;
+
+		if (!strcmp(flag, "-tt1"))
+			print_bin((u32) s << 9 | b, 18);
+		else {
+			if (strcmp(flag, "-s"))   print_bin(b, 9);
+			if (strcmp(flag, "-b"))   print_bin(s, 9);
+		}
+
+		return 0;
+	}
+
+	if (argc > 1)
+		fputs("arguments after the first are ignored.\n", stderr);
+
+	const u16 target = str2tt(flag);
+	const u16 care = four ? 0x1F1F : 0xFFFF; // 5 to 7 neighbors are don't-cares with -4
+	char out[1024];
+
+	if (ternary) {
+		ternary_init(andn);
+		ternary_search(out, target, care);
+	}
+	else {
+		static Formulas f4;
+		Formulas_init(&f4, 4, andn);
+
+		const int tt = Formulas_search(&f4, target, care);
+
+		if (tt < 0) {
+			fputs("no expression found within MAX_COST operations\n", stderr);
+			return 1;
+		}
+
+		Formulas_print(&f4, out, tt, 0, var_names);
+	}
+
+	puts(out);
+	return 0;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#define ATTRACTOR_H
+
+// defines the attractor cache and the Attractor_* API, for `run_once` and run-simd.h.
+
+// almost every trial ends on one of a small set of cycles, and the cycle detectors only
+// notice the repeat after going all the way around it. once a cycle is found, every state
+// on it goes in this cache with the period, and it stays there for the rest of the program.
+// later trials check every ATTRACTOR_STRIDE-th state against the cache, and once one is in
+// it, they step again from the last one that wasn't to find the first state of the cycle.
+// its index is the transient, and the first repeat is exactly one period after it. checking
+// every state would cost more than going around the cycle, since most trials end up on a
+// period 1 or 2 cycle, which are never in the cache.
+
+// only the cycles with a period of at least ATTRACTOR_MIN_PERIOD are added. the shorter
+// ones save a step or two at most, and there are a lot of them, since every arrangement of
+// blinkers and still lifes is a different cycle. most states are not in the cache, so there
+// is a bit filter in front of the table that usually answers with a single load.
+
+#define ATTRACTOR_SLOTS			(1 << ATTRACTOR_BITS)
+#define ATTRACTOR_FILTER_BITS	(ATTRACTOR_BITS + 3)
+
+// cycles are not added past this, so the probes always find an empty slot.
+#define ATTRACTOR_MAX_LEN		(ATTRACTOR_SLOTS / 4 * 3)
+
+_Static_assert(PERIOD_LEN <= UINT16_MAX + 1, "the periods are 16-bit");
+_Static_assert(ATTRACTOR_MIN_PERIOD >= 2, "the empty board is the empty slot value");
+_Static_assert(ATTRACTOR_MAX_LEN / ATTRACTOR_MIN_PERIOD <= UINT16_MAX, "the cycle ids are 16-bit");
+
+static struct {
+	u64 filter[(1 << ATTRACTOR_FILTER_BITS) / 64]; // one bit for each hash value in the cache
+	u64 keys[ATTRACTOR_SLOTS];    // 0 is an empty slot. the empty board is never added
+	u16 periods[ATTRACTOR_SLOTS]; // period of the cycle each state is on
+	u16 ids[ATTRACTOR_SLOTS];     // index of the cycle each state is on, in the order they were added
+	u32 len;                      // number of states in the cache
+	u32 cycles;                   // number of cycles in the cache
+} attractors = {0};
+
+static FORCE_INLINE u64 _attractor_hash(const Matx8 state) {
+	// the filter uses the top ATTRACTOR_FILTER_BITS bits, and the table uses the top ATTRACTOR_BITS.
+	return state.matx * 0x9e3779b97f4a7c15llu;
+}
+
+static FORCE_INLINE u32 _attractor_period2(const Matx8 state, const u32 cycles) {
+	// returns the period of the cycle `state` is on, or 0 if it isn't on one of the first
+	// `cycles` cycles in the cache.
+	const u64 hash = _attractor_hash(state);
+	const u64 bit  = hash >> (64 - ATTRACTOR_FILTER_BITS);
+
+	likelyp_if ((attractors.filter[bit / 64] >> bit % 64 & 1) == 0, 0.97)
+		return 0;
+
+	for (u32 slot = hash >> (64 - ATTRACTOR_BITS);; slot = (slot + 1) % ATTRACTOR_SLOTS) {
+		likelyp_if (attractors.keys[slot] == state.matx, 0.9)
+			return attractors.ids[slot] < cycles ? attractors.periods[slot] : 0;
+
+		likely_if (attractors.keys[slot] == 0)
+			return 0;
+	}
+}
+
+static FORCE_INLINE u32 _attractor_period1(const Matx8 state) {
+	return _attractor_period2(state, attractors.cycles);
+}
+
+// NOTE: a trial can only trust the cycles that were already in the cache when it started.
+//       otherwise, it could have stepped onto the cycle before it was added, and the first
+//       state it finds in the cache would not be the first state of the cycle.
+#define Attractor_period(state, cycles...) \
+	VA_IF(_attractor_period2(state, cycles), _attractor_period1(state), cycles)
+
+static u32 Attractor_enter(Matx8 *const restrict state, u32 step, const u32 cycles) {
+	// `state` is state number `step`, and it isn't past the start of one of the first `cycles`
+	// cycles in the cache, but a later state is on it. steps `state` to the first state of
+	// that cycle, and returns its index.
+	likely_until (Attractor_period(*state, cycles) != 0) {
+		*state = Matx8_next(*state);
+		step++;
+	}
+
+	return step;
+}
+
+static void Attractor_add(Matx8 state, const u32 period) {
+	// `state` is on a cycle with a period of `period`. adds every state of that cycle, unless
+	// it is already there. a trial that started before the cycle was added doesn't trust it, so
+	// the lanes of run-simd.h and run-interleave.h can find the same cycle more than once.
+	likely_if (period < ATTRACTOR_MIN_PERIOD || Attractor_period(state) != 0)
+		return;
+
+	unlikely_if (period > UINT16_MAX || attractors.len + period > ATTRACTOR_MAX_LEN)
+		return; // the whole cycle has to be added, or the transients would come out wrong.
+
+	for (u32 i = 0; i < period; i++) {
+		const u64 hash = _attractor_hash(state);
+		const u64 bit  = hash >> (64 - ATTRACTOR_FILTER_BITS);
+		u32 slot = hash >> (64 - ATTRACTOR_BITS);
+
+		while (attractors.keys[slot] != 0)
+			slot = (slot + 1) % ATTRACTOR_SLOTS;
+
+		attractors.keys[slot]    = state.matx;
+		attractors.periods[slot] = period;
+		attractors.ids[slot]     = attractors.cycles;
+		attractors.filter[bit / 64] |= 1llu << bit % 64;
+
+		state = Matx8_next(state);
+	}
+
+	attractors.len += period;
+	attractors.cycles++;
+}
@@ -0,0 +1,462 @@
+#pragma once
+#define BENCH_H
+
+// micro-benchmarks for the `bnch` command. requires run.h and matx8-bitslice.h.
+
+// every benchmark runs the same inputs through each engine, so besides the speed,
+// it also checks that the engines give the same results. the timings are wall
+// clock, so use `-H` or `-R` if you want them to mean anything.
+
+#include "run-simd.h"
+#include "run-interleave.h"
+
+#if !NH_WIDE
+	#include "matx8-lut.h"
+#endif
+
+static FORCE_INLINE u64 bench_ticks(void) {
+	i64 ticks;
+	QueryPerformanceCounter(&ticks);
+	return ticks;
+}
+
+static double bench_seconds(const u64 ticks) {
+	static i64 frequency = 0;
+
+	unlikely_if (frequency == 0)
+		QueryPerformanceFrequency(&frequency);
+
+	return (double) ticks / (double) frequency;
+}
+
+static void bench_print(const char *const restrict name, const u64 n, const u64 ticks, const char *const restrict unit) {
+	likely_if (!cfg.silent)
+		printf("%-10s %8.3f s  %14.0f %s/sec\n", name, bench_seconds(ticks), n / bench_seconds(ticks), unit);
+}
+
+static Matx8 *bench_states(const u64 n) {
+	// random start states that every engine gets to use.
+	Matx8 *const states = malloc(n * sizeof(Matx8));
+	OOM(states, 5);
+
+	for (u64 i = 0; i < n; i++)
+		states[i] = Matx8_random();
+
+	return states;
+}
+
+static void bench_run(const u64 n) {
+	// scalar `run_once` vs the interleaved engine and the multi-board engine
+	Matx8 *const states = bench_states(n);
+	static u64 expected[COMBINED_HIST_SIZE];
+
+	// interesting states would be logged by both engines, which is just noise here.
+	const bool original_quiet = cfg.quiet;
+	cfg.quiet = true;
+
+	memset(data.raw, 0, DATA_SIZE);
+	u64 t = bench_ticks();
+
+	for (u64 i = 0; i < n; i++)
+		run_once(states[i]);
+
+	bench_print("scalar", n, bench_ticks() - t, "trials");
+	memcpy(expected, data.combined, sizeof expected);
+
+	// the calibrated width, or the most it can be if that is `run_once`.
+	const u32 width = tune.width;
+	char name[16];
+
+	tune.width = width > 1 ? width : INTERLEAVE_K;
+	sprintf(name, "ilv x%u", tune.width);
+
+	memset(data.raw, 0, DATA_SIZE);
+	t = bench_ticks();
+
+	ilv_run(n, states);
+
+	bench_print(name, n, bench_ticks() - t, "trials");
+	tune.width = width;
+
+	likely_if (!cfg.silent)
+		printf("%-10s histograms %s\n", "", memcmp(expected, data.combined, sizeof expected) == 0 ?
+			"match" : "DIFFER");
+
+	memset(data.raw, 0, DATA_SIZE);
+	t = bench_ticks();
+
+	simd_run(n, states);
+
+	bench_print("simd x" TOSTRING_EXPANDED(SIMD_LANES), n, bench_ticks() - t, "trials");
+
+	likely_if (!cfg.silent)
+		printf("%-10s histograms %s\n", "", memcmp(expected, data.combined, sizeof expected) == 0 ?
+			"match" : "DIFFER");
+
+	cfg.quiet = original_quiet;
+	free(states);
+}
+
+static FORCE_INLINE u64 _bench_cycle1(const Matx8 *const restrict states, const u64 n, const u8 how, const char *const restrict name) {
+	// runs every state with the detector `how`, and returns the most memory it used, in bytes.
+	u32 tail = 0;
+	cycle.max_depth = 0;
+	memset(data.raw, 0, DATA_SIZE);
+
+	u64 t = bench_ticks();
+
+	for (u64 i = 0; i < n; i++) {
+		_run_once3(states[i], how, false);
+
+		if ((how == CYCLE_TABLE || how == CYCLE_SYMMETRY) && hashtable.tail > tail)
+			tail = hashtable.tail;
+	}
+
+	bench_print(name, n, bench_ticks() - t, "trials");
+
+	switch (how) {
+	case CYCLE_TABLE:   return (TABLE_LEN + tail) * TABLE_SLOT_SIZE;
+	case CYCLE_BRENT:   return sizeof(CycleEntry);
+	case CYCLE_NIVASCH: return cycle.max_depth * sizeof(CycleEntry);
+	case CYCLE_SYMMETRY: return (TABLE_LEN + tail) * TABLE_SLOT_SIZE + sizeof board_path;
+	default: __builtin_unreachable();
+	}
+}
+
+static void bench_cycle(const u64 n) {
+	// trials/sec of run_once with each cycle detector, and the most memory each one needed
+	// for a single trial. use `-r` for other rulesets, e.g. B23/S23 with VON_NEUMANN has
+	// much longer transients than B3/S23.
+	Matx8 *const states = bench_states(n);
+	static u64 expected[COMBINED_HIST_SIZE];
+	u64 bytes;
+
+	const bool original_quiet = cfg.quiet;
+	cfg.quiet = true;
+
+	bytes = _bench_cycle1(states, n, CYCLE_TABLE, "table");
+	memcpy(expected, data.combined, sizeof expected);
+
+	likely_if (!cfg.silent)
+		printf("%-10s %8zu bytes\n", "", bytes);
+
+	bytes = _bench_cycle1(states, n, CYCLE_BRENT, "brent");
+
+	likely_if (!cfg.silent)
+		printf("%-10s %8zu bytes, histograms %s\n", "", bytes,
+			memcmp(expected, data.combined, sizeof expected) == 0 ? "match" : "DIFFER");
+
+	bytes = _bench_cycle1(states, n, CYCLE_NIVASCH, "nivasch");
+
+	likely_if (!cfg.silent)
+		printf("%-10s %8zu bytes, histograms %s\n", "", bytes,
+			memcmp(expected, data.combined, sizeof expected) == 0 ? "match" : "DIFFER");
+
+	bytes = _bench_cycle1(states, n, CYCLE_SYMMETRY, "symmetry");
+
+	likely_if (!cfg.silent)
+		printf("%-10s %8zu bytes, histograms %s\n", "", bytes,
+			memcmp(expected, data.combined, sizeof expected) == 0 ? "match" : "DIFFER");
+
+	cfg.quiet = original_quiet;
+	free(states);
+}
+
+#if MEMO_CACHE
+static void bench_memo(const u64 n) {
+	// run_once without and with the memo, which starts out empty. the hit rate keeps going
+	// up with the number of trials, so try a few different values of N.
+	Matx8 *const states = bench_states(n);
+	static u64 expected[COMBINED_HIST_SIZE];
+
+	const bool original_quiet = cfg.quiet;
+	cfg.quiet = true;
+
+	memset(data.raw, 0, DATA_SIZE);
+	u64 t = bench_ticks();
+
+	for (u64 i = 0; i < n; i++)
+		_run_once3(states[i], CYCLE_DETECT, false);
+
+	bench_print("no memo", n, bench_ticks() - t, "trials");
+	memcpy(expected, data.combined, sizeof expected);
+
+	Memo_reset();
+	memset(data.raw, 0, DATA_SIZE);
+	t = bench_ticks();
+
+	for (u64 i = 0; i < n; i++)
+		_run_once3(states[i], CYCLE_DETECT, true);
+
+	bench_print("memo", n, bench_ticks() - t, "trials");
+
+	likely_if (!cfg.silent) {
+		printf("%-10s %zu lookups, %.2f%% hits, %zu false hits\n", "", memo.lookups,
+			100.0 * memo.hits / (memo.lookups ? memo.lookups : 1), memo.false_hits);
+		printf("%-10s %zu/%u entries used, histograms %s\n", "", memo.len, 1 << MEMO_BITS,
+			memcmp(expected, data.combined, sizeof expected) == 0 ? "match" : "DIFFER");
+	}
+
+	cfg.quiet = original_quiet;
+	free(states);
+}
+#endif
+
+static void bench_step(const u64 n) {
+	// 64 generations of `Matx8_next` on each board vs the bit-sliced engine.
+	// the bit-sliced time includes the transposes in and out.
+	Matx8 *const expected = bench_states(n);
+	Matx8 *const states = malloc(n * sizeof(Matx8));
+	OOM(states, 5);
+	memcpy(states, expected, n * sizeof(Matx8));
+
+	u64 t = bench_ticks();
+
+	for (u64 i = 0; i < n; i++)
+		for (u8 j = 0; j < 64; j++)
+			expected[i] = Matx8_next(expected[i]);
+
+	bench_print("scalar", 64*n, bench_ticks() - t, "steps");
+	t = bench_ticks();
+
+	Matx8_nextn_many(states, n, 64);
+
+	bench_print("bitslice", 64*n, bench_ticks() - t, "steps");
+
+	likely_if (!cfg.silent)
+		printf("states %s\n", memcmp(expected, states, n * sizeof(Matx8)) == 0 ?
+			"match" : "DIFFER");
+
+	free(expected);
+	free(states);
+}
+
+// the rest are for the 3x3 kernels, which the wide neighborhoods don't use.
+#if !NH_WIDE
+static FORCE_INLINE void _bench_bitwise(Matx8 *const restrict states, const u64 n, const u8 nh) {
+	// `nh` is always a constant, so this compiles to the same code as Matx8_next would.
+	for (u64 i = 0; i < n; i++)
+		for (u8 j = 0; j < 16; j++)
+			states[i].matx = _MATX8_NEXT(u64, nh, states[i].matx, Matx8__xroll_u, Matx8__yroll_u);
+}
+
+static void _bench_lut1(const Matx8 *const restrict inputs, const u64 n, const u8 nh, const char *const restrict name) {
+	// NEXT_COND for the neighborhood `nh` vs the row table for the same rule.
+	Matx8 *const expected = malloc(n * sizeof(Matx8));
+	Matx8 *const states = malloc(n * sizeof(Matx8));
+	OOM(expected, 5);
+	OOM(states, 5);
+	memcpy(expected, inputs, n * sizeof(Matx8));
+	memcpy(states, inputs, n * sizeof(Matx8));
+
+	likely_if (!cfg.silent)
+		printf("%s:\n", name);
+
+	u64 t = bench_ticks();
+
+	switch (nh) {
+	case NH_MOORE:       _bench_bitwise(expected, n, NH_MOORE); break;
+	case NH_VON_NEUMANN: _bench_bitwise(expected, n, NH_VON_NEUMANN); break;
+	case NH_DIAGONAL:    _bench_bitwise(expected, n, NH_DIAGONAL); break;
+	}
+
+	bench_print("bitwise", 16*n, bench_ticks() - t, "steps");
+	t = bench_ticks();
+
+	Matx8_lut_init(Rule3x3_from_cond(nh));
+
+	bench_print("lut init", 1, bench_ticks() - t, "tables");
+	t = bench_ticks();
+
+	for (u64 i = 0; i < n; i++)
+		for (u8 j = 0; j < 16; j++)
+			states[i] = Matx8__next_lut(states[i]);
+
+	bench_print("lut", 16*n, bench_ticks() - t, "steps");
+
+	likely_if (!cfg.silent)
+		printf("states %s\n", memcmp(expected, states, n * sizeof(Matx8)) == 0 ?
+			"match" : "DIFFER");
+
+	memcpy(states, inputs, n * sizeof(Matx8));
+	t = bench_ticks();
+
+	Matx8_nextn_many_lut(states, n, 16);
+
+	bench_print("lut x8", 16*n, bench_ticks() - t, "steps");
+
+	likely_if (!cfg.silent)
+		printf("states %s\n", memcmp(expected, states, n * sizeof(Matx8)) == 0 ?
+			"match" : "DIFFER");
+
+	free(expected);
+	free(states);
+}
+
+static void bench_lut(const u64 n) {
+	// 16 generations of each board with the bitwise kernel and the row table kernel,
+	// for NEXT_COND in each of the neighborhoods. the table cost doesn't depend on the
+	// rule or neighborhood, so the bitwise one gets relatively faster with fewer neighbors.
+	Matx8 *const states = bench_states(n);
+
+	_bench_lut1(states, n, NH_MOORE, "MOORE");
+	_bench_lut1(states, n, NH_VON_NEUMANN, "VON_NEUMANN");
+	_bench_lut1(states, n, NH_DIAGONAL, "DIAGONAL");
+
+	free(states);
+
+#if KERNEL == KERNEL_LUT
+	// put back the table for the actual rule.
+	Matx8_lut_init_default();
+#endif
+}
+
+// runs 16 generations of every board with the counter `count` on planes of type `T`,
+// which is either u64 or u64xN, and checks the result against `expected`.
+// `n` has to be a multiple of SIMD_LANES.
+#define _BENCH_GEN(count, T, xroll, yroll, nh, name) ({                              \
+	memcpy(states, inputs, n * sizeof(Matx8));                                        \
+	u64 t = bench_ticks();                                                            \
+	                                                                                  \
+	for (u64 i = 0; i < n; i += sizeof(T) / sizeof(u64)) {                            \
+		T state;                                                                      \
+		memcpy(&state, states + i, sizeof state);                                     \
+		                                                                              \
+		for (u8 j = 0; j < 16; j++)                                                   \
+			state = _MATX8_NEXT_WITH(count, T, nh, state, xroll, yroll);              \
+		                                                                              \
+		memcpy(states + i, &state, sizeof state);                                     \
+	}                                                                                 \
+	                                                                                  \
+	bench_print(name, 16*n, bench_ticks() - t, "gens");                              \
+	                                                                                  \
+	unlikely_if (memcmp(expected, states, n * sizeof(Matx8)) != 0)                    \
+		printf("states DIFFER\n");                                                    \
+})
+
+static FORCE_INLINE void _bench_gen1(
+	const Matx8 *const restrict inputs,
+	Matx8 *const restrict expected,
+	Matx8 *const restrict states,
+	const u64 n,
+	const u8 nh,
+	const char *const restrict name
+) {
+	// `nh` is always a constant, so everything compiles to the same code as Matx8_next.
+	likely_if (!cfg.silent)
+		printf("%s:\n", name);
+
+	// the expected states don't depend on the counter.
+	memcpy(expected, inputs, n * sizeof(Matx8));
+
+	for (u64 i = 0; i < n; i++)
+		for (u8 j = 0; j < 16; j++)
+			expected[i].matx = _MATX8_NEXT_WITH(_MATX8_COUNT_SERIAL, u64, nh,
+				expected[i].matx, Matx8__xroll_u, Matx8__yroll_u);
+
+	_BENCH_GEN(_MATX8_COUNT_SERIAL, u64, Matx8__xroll_u, Matx8__yroll_u, nh, "serial");
+	_BENCH_GEN(_MATX8_COUNT_CSA, u64, Matx8__xroll_u, Matx8__yroll_u, nh, "csa");
+	_BENCH_GEN(_MATX8_COUNT_SERIAL, u64xN, Matx8xN__xroll_u, Matx8xN__yroll_u, nh,
+		"serial x" TOSTRING_EXPANDED(SIMD_LANES));
+	_BENCH_GEN(_MATX8_COUNT_CSA, u64xN, Matx8xN__xroll_u, Matx8xN__yroll_u, nh,
+		"csa x" TOSTRING_EXPANDED(SIMD_LANES));
+}
+
+static void bench_gen(u64 n) {
+	// generations/sec of the serial and carry-save adder neighbor counters, on single
+	// boards and on SIMD_LANES boards at once, for each neighborhood. with ISA=avx512,
+	// the csa ones use VPTERNLOG for the vectors. build for each ISA to compare them.
+	n = (n + SIMD_LANES - 1) / SIMD_LANES * SIMD_LANES;
+
+	Matx8 *const inputs = bench_states(n);
+	Matx8 *const expected = malloc(n * sizeof(Matx8));
+	Matx8 *const states = malloc(n * sizeof(Matx8));
+	OOM(expected, 5);
+	OOM(states, 5);
+
+	_bench_gen1(inputs, expected, states, n, NH_MOORE, "MOORE");
+	_bench_gen1(inputs, expected, states, n, NH_VON_NEUMANN, "VON_NEUMANN");
+	_bench_gen1(inputs, expected, states, n, NH_DIAGONAL, "DIAGONAL");
+
+	free(inputs);
+	free(expected);
+	free(states);
+}
+
+#if RUNTIME_RULESET
+static void _bench_rule1(
+	const Matx8 *const restrict inputs,
+	Matx8 *const restrict expected,
+	Matx8 *const restrict states,
+	const u64 n,
+	const u16 tt,
+	const u8 kind,
+	const char *const restrict name
+) {
+	// the condition for `kind` vs the truth table evaluation for the same ruleset.
+	Ruleset_set(name, tt);
+
+	likely_if (!cfg.silent)
+		printf("%s:\n", name);
+
+	for (u8 simd = 0; simd < 2; simd++) {
+		for (u8 i = 0; i < 2; i++) {
+			Matx8 *const out = i == 0 ? expected : states;
+			memcpy(out, inputs, n * sizeof(Matx8));
+			ruleset.kind = i == 0 ? kind : RULESET_ANF;
+
+			u64 t = bench_ticks();
+
+			if (simd)
+				for (u64 j = 0; j < n; j += SIMD_LANES) {
+					Matx8xN lanes;
+					memcpy(&lanes, out + j, sizeof lanes);
+
+					for (u8 k = 0; k < 16; k++)
+						lanes = Matx8xN_next(lanes);
+
+					memcpy(out + j, &lanes, sizeof lanes);
+				}
+			else
+				for (u64 j = 0; j < n; j++)
+					for (u8 k = 0; k < 16; k++)
+						out[j] = Matx8_next(out[j]);
+
+			bench_print(i == 0 ? simd ? "fast x" TOSTRING_EXPANDED(SIMD_LANES) : "fast" :
+				simd ? "anf x" TOSTRING_EXPANDED(SIMD_LANES) : "anf", 16*n, bench_ticks() - t, "gens");
+		}
+
+		unlikely_if (memcmp(expected, states, n * sizeof(Matx8)) != 0)
+			printf("states DIFFER\n");
+	}
+}
+
+static void bench_rule(u64 n) {
+	// generations/sec of each ruleset fast path (including the compiled NEXT_COND) vs the
+	// truth table evaluation that `-r` uses for every other ruleset, for the compiled
+	// neighborhood. the difference is the cost of a ruleset without a fast path.
+	n = (n + SIMD_LANES - 1) / SIMD_LANES * SIMD_LANES;
+
+	Matx8 *const inputs = bench_states(n);
+	Matx8 *const expected = malloc(n * sizeof(Matx8));
+	Matx8 *const states = malloc(n * sizeof(Matx8));
+	OOM(expected, 5);
+	OOM(states, 5);
+
+	const typeof(ruleset) original = ruleset;
+
+	_bench_rule1(inputs, expected, states, n, Ruleset_compiled_tt(), RULESET_COMPILED, RULESET);
+	_bench_rule1(inputs, expected, states, n, _RULESET_TT_OF(_RULESET_COND_LIFE), RULESET_LIFE, "B3/S23");
+	_bench_rule1(inputs, expected, states, n, _RULESET_TT_OF(_RULESET_COND_HIGHLIFE), RULESET_HIGHLIFE, "B36/S23");
+	_bench_rule1(inputs, expected, states, n, _RULESET_TT_OF(_RULESET_COND_SEEDS), RULESET_SEEDS, "B2/S");
+	_bench_rule1(inputs, expected, states, n, _RULESET_TT_OF(_RULESET_COND_REPLICATOR), RULESET_REPLICATOR, "B1357/S1357");
+	_bench_rule1(inputs, expected, states, n, _RULESET_TT_OF(_RULESET_COND_LWOD), RULESET_LWOD, "B3/S012345678");
+
+	ruleset = original;
+
+	free(inputs);
+	free(expected);
+	free(states);
+}
+#endif
+#endif // !NH_WIDE
@@ -0,0 +1,223 @@
+#pragma once
+#define BOARD_H
+
+// defines Board, the torus that the run commands step, and the Board_* API.
+
+// BOARD_SIZE is the side length. 8 is just Matx8, and all of these are the Matx8
+// functions. for 16 and 32, each row is a u16 or u32, and the rows are packed into a
+// vector of u64s, so a 16x16 board is one AVX2 register, and a 32x32 board is two
+// AVX-512 registers. the same rule macros as Matx8xN step them, with rolls that work
+// on the packed rows instead of bytes.
+
+// the cycle table keys are 64 bits, so the bigger boards are stored as a fingerprint
+// (Board_key), and run.h compares the real board when the fingerprint is found.
+
+#include "matx8.h"
+#include "matx8-next.h"
+
+#define BOARD_CELLS (BOARD_SIZE * BOARD_SIZE)
+#define BOARD_STR_LEN (2 + BOARD_CELLS/4 + 1) // "0x", the hex digits, and the null terminator
+
+#if BOARD_SIZE == 8
+	typedef u64 BoardV;
+	typedef Matx8 Board;
+#elif BOARD_SIZE == 16 || BOARD_SIZE == 32
+	#define BOARD_WORDS (BOARD_CELLS / 64)
+
+	#if BOARD_SIZE == 16
+		typedef u16 BoardRow;
+		#define _BOARD_WORD_IDX {0, 1, 2, 3}
+	#else
+		typedef u32 BoardRow;
+		#define _BOARD_WORD_IDX {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}
+	#endif
+
+	typedef u64 BoardV __attribute__((vector_size(BOARD_WORDS * sizeof(u64))));
+
+	typedef union {
+		BoardV matx;                  // the whole board as one vector
+		u64 words[BOARD_WORDS];       // BOARD_SIZE/16 rows per word. row 0 is the lowest bits
+		BoardRow rows[BOARD_SIZE];    // each row as a separate integer
+	} Board;
+#else
+	#error "BOARD_SIZE must be 8, 16, or 32"
+#endif
+
+#if BOARD_SIZE != 8 && KERNEL == KERNEL_LUT
+	#error "KERNEL_LUT only supports 8x8 boards"
+#endif
+
+#if BOARD_SIZE == 8
+
+static FORCE_INLINE Board Board_next(const Board this) { return Matx8_next(this); }
+static FORCE_INLINE Matx8 Board_key(const Board this)  { return this; }
+static FORCE_INLINE Board Board_random(void)           { return Matx8_random(); }
+
+static FORCE_INLINE bool Board__empty_u(const BoardV state) { return state == 0; }
+static FORCE_INLINE u32 Board__popcnt_u(const BoardV state) { return POPCNT(state); }
+
+static FORCE_INLINE char *Board_sprint(char *restrict buf, const Board this) {
+	return buf + sprintf(buf, "%#018zx", this.matx);
+}
+
+static Board Board_tfm(const Board this, const u8 tfm, const u8 x, const u8 y) {
+	return Matx8_yroll(Matx8_xroll(Matx8_tfm(this, tfm), x), y);
+}
+
+#else // BOARD_SIZE != 8
+
+// the low BOARD_SIZE - x bits of each row, like Matx8_xroll_masks.
+#define _BOARD_XROLL_MASK(x) ((u64) -1 / (u64) (BoardRow) -1 * (((u64) 1 << (BOARD_SIZE - (x))) - 1))
+
+static FORCE_INLINE BoardV Board__xroll_u(const BoardV state, u8 x) {
+	// a positive roll rotates right (towards smaller bit indices). x is mod BOARD_SIZE.
+	x %= BOARD_SIZE;
+
+	if (x == 0)
+		return state;
+
+	const u64 mask = _BOARD_XROLL_MASK(x);
+
+	return (state >> x) & mask | (state << (BOARD_SIZE - x)) & ~mask;
+}
+
+static FORCE_INLINE BoardV Board__yroll_u(const BoardV state, u8 y) {
+	// a positive roll rotates down (towards smaller bit indices). y is mod BOARD_SIZE.
+	// the whole board is rotated as one big integer, so word i gets parts of words
+	// i + q and i + q + 1. the shuffles are constant when y is.
+	const u32 bits = y % BOARD_SIZE * BOARD_SIZE;
+	const u8 q = bits / 64, r = bits % 64;
+	const BoardV idx = _BOARD_WORD_IDX, lo = __builtin_shuffle(state, idx + q & BOARD_WORDS - 1);
+
+	if (r == 0)
+		return lo;
+
+	return lo >> r | __builtin_shuffle(state, idx + q + 1 & BOARD_WORDS - 1) << (64 - r);
+}
+
+// the rule macros roll by 1 and 7 for the Matx8 offsets of +1 and -1, and the wide
+// neighborhoods use 6 and 7 for -2 and -1, so these turn 4 to 7 into -4 to -1 first.
+static FORCE_INLINE BoardV Board__xroll_nh(const BoardV state, const u8 x) {
+	return Board__xroll_u(state, x < 4 ? x : x + BOARD_SIZE - 8);
+}
+
+static FORCE_INLINE BoardV Board__yroll_nh(const BoardV state, const u8 y) {
+	return Board__yroll_u(state, y < 4 ? y : y + BOARD_SIZE - 8);
+}
+
+static Board Board_next(const Board this) {
+#if NH_WIDE
+	return (Board) {.matx = RULESET_EVAL(BoardV, _MATX8_NEXT_WIDE, BoardV, this.matx,
+		Board__xroll_nh, Board__yroll_nh)};
+#else
+	return (Board) {.matx = RULESET_EVAL(BoardV, _MATX8_NEXT_EVAL, COUNTER, BoardV, NEIGHBORHOOD,
+		this.matx, Board__xroll_nh, Board__yroll_nh)};
+#endif
+}
+
+static FORCE_INLINE Matx8 Board_key(const Board this) {
+	// 64-bit fingerprint of the board. each pair of words is mixed with a 64x64 -> 128 bit
+	// multiply, like wyhash. the products are independent, so they all run in parallel.
+	static const u64 keys[BOARD_WORDS] = {
+		0xa0761d6478bd642fllu, 0xe7037ed1a0b428dbllu, 0x8ebc6af09c88c6e3llu, 0x589965cc75374cc3llu,
+	#if BOARD_WORDS > 4
+		0x1d8e4e27c47d124fllu, 0x9e3779b97f4a7c15llu, 0xbf58476d1ce4e5b9llu, 0x94d049bb133111ebllu,
+		0xd6e8feb86659fd93llu, 0xc2b2ae3d27d4eb4fllu, 0x165667b19e3779f9llu, 0x27d4eb2f165667c5llu,
+		0xff51afd7ed558ccdllu, 0xc4ceb9fe1a85ec53llu, 0x87c37b91114253d5llu, 0x4cf5ad432745937fllu,
+	#endif
+	};
+
+	u64 fp = 0;
+
+	for (u8 i = 0; i < BOARD_WORDS; i += 2) {
+		const u128 m = (u128) (this.words[i] ^ keys[i]) * (this.words[i + 1] ^ keys[i + 1]);
+		fp ^= (u64) m ^ (u64) (m >> 64);
+	}
+
+	return (Matx8) {.matx = fp};
+}
+
+static FORCE_INLINE Board Board_random(void) {
+	Board this;
+
+	for (u8 i = 0; i < BOARD_WORDS; i++)
+		this.words[i] = Matx8_random().matx;
+
+	return this;
+}
+
+static FORCE_INLINE bool Board__empty_u(const BoardV state) {
+	u64 any = 0;
+
+	for (u8 i = 0; i < BOARD_WORDS; i++)
+		any |= state[i];
+
+	return any == 0;
+}
+
+static FORCE_INLINE u32 Board__popcnt_u(const BoardV state) {
+	u32 count = 0;
+
+	for (u8 i = 0; i < BOARD_WORDS; i++)
+		count += POPCNT(state[i]);
+
+	return count;
+}
+
+static char *Board_sprint(char *restrict buf, const Board this) {
+	// writes the board as one big hex number. returns a pointer to the null terminator.
+	// needs BOARD_STR_LEN bytes.
+	buf = ememcpy(buf, "0x", 2);
+
+	for (u8 i = BOARD_WORDS; i --> 0 ;)
+		buf += sprintf(buf, "%016zx", this.words[i]);
+
+	return buf;
+}
+
+static Board Board_tfm(const Board this, const u8 tfm, const u8 x, const u8 y) {
+	// transform, then roll. the same thing as the Matx8 ones, but one cell at a time,
+	// since it only runs once for the `tfm` command.
+	constexpr u8 m = BOARD_SIZE - 1;
+	Board out = {0};
+
+	for (u8 r = 0; r < BOARD_SIZE; r++) {
+		for (u8 c = 0; c < BOARD_SIZE; c++) {
+			if ((this.rows[r] >> c & 1) == 0)
+				continue;
+
+			u8 c2, r2;
+
+			switch (tfm) {
+			case TFM_IDENTITY: c2 = c;     r2 = r;     break;
+			case TFM_YFLIP:    c2 = c;     r2 = m - r; break;
+			case TFM_XFLIP:    c2 = m - c; r2 = r;     break;
+			case TFM_TRS:      c2 = r;     r2 = c;     break;
+			case TFM_ANTI_TRS: c2 = m - r; r2 = m - c; break;
+			case TFM_ROT180:   c2 = m - c; r2 = m - r; break;
+			case TFM_ROT90:    c2 = r;     r2 = m - c; break;
+			case TFM_ROT270:   c2 = m - r; r2 = c;     break;
+			default:
+				__builtin_unreachable();
+			}
+
+			c2 = c2 - x & m;
+			r2 = r2 - y & m;
+			out.rows[r2] |= (BoardRow) 1 << c2;
+		}
+	}
+
+	return out;
+}
+
+#endif // BOARD_SIZE
+
+// derived functions
+
+static FORCE_INLINE bool Board_eq(const Board a, const Board b) {
+	return Board__empty_u(a.matx ^ b.matx);
+}
+
+static FORCE_INLINE bool Board__full_u(const BoardV state) {
+	return Board__empty_u(~state);
+}
@@ -3,36 +3,33 @@
 
 // backwards search
 
-#ifndef B_TT
-	#pragma message("B_TT not defined. assuming B2")
-	#define B_TT 0b000000100u
-#endif
+// the birth and survival truth tables. bit n is set if n neighbors gives an alive cell.
+// these are the runtime ones, so they always match Matx8_next, even with `-r`.
+#define B_TT ruleset.b_tt
+#define S_TT ruleset.s_tt
+
+static u64 _tt_pred_count(const u32 tt) {
+	// \sum_{i=0}^N (tt bit i) * (N choose i), for N = NH_NEIGHBORS
+	u64 count = 0, choose = 1;
+
+	for (u8 i = 0; i <= NH_NEIGHBORS; i++) {
+		count += (tt >> i & 1) * choose;
+		choose = choose * (NH_NEIGHBORS - i) / (i + 1);
+	}
 
-#ifndef S_TT
-	#pragma message("S_TT not defined. assuming S23")
-	#define S_TT 0b000001100u
-#endif
+	return count;
+}
 
 // truth table to predecessor count (alive cells)
-// \sum_{i=0}^8 (tt bit i) * (8 choose i)
-#define TT2PDCNT_A(tt) ((u16) ( \
-	((tt >> 0) & 1) *  1 + \
-	((tt >> 1) & 1) *  8 + \
-	((tt >> 2) & 1) * 28 + \
-	((tt >> 3) & 1) * 56 + \
-	((tt >> 4) & 1) * 70 + \
-	((tt >> 5) & 1) * 56 + \
-	((tt >> 6) & 1) * 28 + \
-	((tt >> 7) & 1) *  8 + \
-	((tt >> 8) & 1) *  1   \
-))
+#define TT2PDCNT_A(tt) _tt_pred_count(tt)
 
 // truth table to predecessor count (dead cells)
-// 256 = 2^8 = \sum_{i=0}^8 (8 choose i)
-#define TT2PDCNT_D(tt) ((u16) (256 - TT2PDCNT_A(tt)))
+// 2^N = \sum_{i=0}^N (N choose i)
+#define TT2PDCNT_D(tt) ((1llu << NH_NEIGHBORS) - TT2PDCNT_A(tt))
 
-#define ALIVE_PRED_COUNT() (TT2PDCNT_A(B_TT) + TT2PDCNT_A(S_TT))
-#define DEAD_PRED_COUNT()  (TT2PDCNT_D(B_TT) + TT2PDCNT_D(S_TT))
+// the survival table is shifted when the center counts, so bit i is for i other neighbors.
+#define ALIVE_PRED_COUNT() (TT2PDCNT_A(B_TT) + TT2PDCNT_A(S_TT >> NH_CENTER))
+#define DEAD_PRED_COUNT()  (TT2PDCNT_D(B_TT) + TT2PDCNT_D(S_TT >> NH_CENTER))
 
 #define BW_SEARCH_ONES_BETTER()  (ALIVE_PRED_COUNT() < DEAD_PRED_COUNT())
 #define BW_SEARCH_ZEROS_BETTER() (ALIVE_PRED_COUNT() > DEAD_PRED_COUNT())
@@ -209,7 +206,7 @@ static Matx8 *_gen_combos(Matx8 *restrict out, Matx8 *restrict arr, Matx8 center
 	// each element in `arr`, should be something like `1llu << bit`
 	// NOTE: `out` must point to somewhere in the program scratch buffer
 
-	if (n > 8 || k > 8 || k > n)
+	if (n > NH_NEIGHBORS || k > n)
 		return out;
 
 	if (k == 0) {
@@ -217,7 +214,10 @@ static Matx8 *_gen_combos(Matx8 *restrict out, Matx8 *restrict arr, Matx8 center
 		return out + 1;
 	}
 
-	u8 indices[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+	u8 indices[NH_NEIGHBORS];
+
+	for (u8 i = 0; i < k; i++)
+		indices[i] = i;
 
 	while (true) {
 		// combine the states together and output the state
@@ -254,89 +254,70 @@ static Matx8 *_gen_combos(Matx8 *restrict out, Matx8 *restrict arr, Matx8 center
 	return out;
 }
 
+// the cell for the neighbor at (x, y) of the cell `c`, for NH_OFFSETS. it is the opposite
+// roll of _NH_PLANE, since this moves the cell to its neighbor instead of the other way.
+#define _NH_CELL(x, y, buf, len, c) \
+	(buf)[(len)++].matx = Matx8__yroll_u(Matx8__xroll_u(c, -(x) & 7), -(y) & 7);
+
+static FORCE_INLINE u64 _nh_mask(const u8 bit) {
+	// every neighbor of the cell `bit`, not including itself.
+	Matx8 nbuf[NH_NEIGHBORS];
+	u8 len = 0;
+	u64 mask = 0;
+
+	NH_OFFSETS(_NH_CELL, nbuf, len, 1llu << bit)
+
+	for (u8 i = 0; i < NH_NEIGHBORS; i++)
+		mask |= nbuf[i].matx;
+
+	return mask;
+}
+
+static bool _nh_tfm_ok(const u8 tfm) {
+	// whether the transformation maps the neighborhood onto itself. the search can only use
+	// the ones that do, since the transformed state is searched with the same neighborhood.
+	// all of them do for the 3x3 ones, but the hex neighborhood only has half of them.
+	const u8 bit = __builtin_ctzll(Matx8_tfm((u64) 1, tfm));
+	return Matx8_tfm(_nh_mask(0), tfm) == _nh_mask(bit);
+}
+
 static u64 states_for_bit(const u8 bit, const bool alive) {
 	// writes the temporary states to the scratch buffer
 	// does not add the bitmask to the start of the array
 	// returns the number of objects it created
 	// `alive` is the value of the current cell in the next state
 
-	// x0 x1 x2
-	// x3 x4 x5
-	// x6 x7 x8
-	const Matx8 x4 = {.matx = 1llu << bit};
+	const Matx8 center = {.matx = 1llu << bit};
 
 	Matx8 *out = (Matx8 *) hashtable.scratch;
 
-	constexpr u8 max_neighbors = 4 << (NEIGHBORHOOD == NH_MOORE);
-
-	Matx8 nbuf[max_neighbors]; // neighbor buffer
-
-	const Matx8 // center left, center right
-		x3 = {.matx = (x4.matx >> 7) & 0x0101010101010101llu | (x4.matx << 1) & 0xfefefefefefefefellu},
-		x5 = {.matx = (x4.matx >> 1) & 0x7f7f7f7f7f7f7f7fllu | (x4.matx << 7) & 0x8080808080808080llu};
+	// TODO: it might be faster to store these in reverse order.
+	//       probably runtime profiling would determine which is better.
 
-#if NEIGHBORHOOD == NH_MOORE || NEIGHBORHOOD == NH_VON_NEUMANN
-	const Matx8
-		x1 = {.matx = ROL(x4.matx, 8)},
-		x7 = {.matx = ROR(x4.matx, 8)};
-#endif
+	Matx8 nbuf[NH_NEIGHBORS]; // neighbor buffer, in the order of NH_OFFSETS
+	u8 len = 0;
 
-#if NEIGHBORHOOD == NH_MOORE || NEIGHBORHOOD == NH_DIAGONAL
-	const Matx8
-		x0 = {.matx = ROL(x3.matx, 8)},
-		x2 = {.matx = ROL(x5.matx, 8)},
-		x6 = {.matx = ROR(x3.matx, 8)},
-		x8 = {.matx = ROR(x5.matx, 8)};
-#endif
+	NH_OFFSETS(_NH_CELL, nbuf, len, center.matx)
 
-	// TODO: it might be faster to store these in reverse order.
-	//       probably runtime profiling would determine which is better.
+	Matx8 bits = center;
 
-#if NEIGHBORHOOD == NH_MOORE
-	;nbuf[0] = x0; nbuf[1] = x1; nbuf[2] = x2;
-	;nbuf[3] = x3;               nbuf[4] = x5;
-	;nbuf[5] = x6; nbuf[6] = x7; nbuf[7] = x8;
-
-	const Matx8 bits = {
-		.matx = x0.matx | x1.matx | x2.matx |
-				x3.matx | x4.matx | x5.matx |
-				x6.matx | x7.matx | x8.matx
-	};
-#elif NEIGHBORHOOD == NH_VON_NEUMANN
-	;              nbuf[0] = x1;            ;
-	;nbuf[1] = x3;              nbuf[2] = x5;
-	;              nbuf[3] = x7;            ;
-
-	const Matx8 bits = {
-		.matx =           x1.matx |
-				x3.matx | x4.matx | x5.matx |
-				          x7.matx
-	};
-#else // NH_DIAGONAL
-	;nbuf[0] = x0;              nbuf[1] = x2;
-	;                                       ;
-	;nbuf[2] = x6;              nbuf[3] = x8;
-
-	const Matx8 bits = {
-		.matx = x0.matx |           x2.matx |
-				          x4.matx |
-				x6.matx |           x8.matx
-	};
-#endif
+	for (u8 i = 0; i < NH_NEIGHBORS; i++)
+		bits.matx |= nbuf[i].matx;
 
 	*out++ = bits;
 
-	for (u8 neighbors = 0; neighbors <= max_neighbors; neighbors++) {
+	for (u8 neighbors = 0; neighbors <= NH_NEIGHBORS; neighbors++) {
 		// the XORs are there because the birth and survive numbers are for if
 		// the next state's cell is alive. if it isn't, then the bits need to be flipped.
 
 		// cases where it used to be dead (e.g. center == 0)
 		if (((B_TT >> neighbors) & 1) ^ !alive)
-			out = _gen_combos(out, nbuf, (Matx8) {0}, max_neighbors, neighbors);
+			out = _gen_combos(out, nbuf, (Matx8) {0}, NH_NEIGHBORS, neighbors);
 
-		// cases where it used to be alive (e.g. center != 0)
-		if (((S_TT >> neighbors) & 1) ^ !alive)
-			out = _gen_combos(out, nbuf, x4, max_neighbors, neighbors);
+		// cases where it used to be alive (e.g. center != 0). it is one of its own
+		// neighbors with NH_CENTER.
+		if (((S_TT >> (neighbors + NH_CENTER)) & 1) ^ !alive)
+			out = _gen_combos(out, nbuf, center, NH_NEIGHBORS, neighbors);
 	}
 
 	// minus 1 because the 0th element is not part of the list
@@ -452,6 +433,9 @@ static const StateBuffer *_find_predecessors2mb(Matx8 state, const bool check_ke
 		u64 best_val = BW_SEARCH_ONES_BETTER() ? 0 : UINT64_MAX;
 
 		for (u8 tfm = 0; tfm < sizeof(tfm_strs) / sizeof(*tfm_strs); tfm++) {
+			if (!_nh_tfm_ok(tfm))
+				continue;
+
 			const Matx8 tfm_state = Matx8_tfm(state, tfm);
 
 			for (u8 y = 0; y < 8; y++) {
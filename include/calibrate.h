@@ -0,0 +1,316 @@
+#pragma once
+#define CALIBRATE_H
+
+// defines `--calibrate` and the loading of CALIBFILE at startup. requires run.h.
+
+// the fastest table size, random buffer length, and batch width depend on the size of the
+// L1, on hyperthreading, and on how fast the CPU is at the multiplies, so the compiled ones
+// are wrong on some machines. `calibrate` times nrun with each candidate, one size at a time
+// with the others left where they are, and saves the fastest ones to CALIBFILE. every run
+// after that loads them in `Calibrate_load`, as long as the file is for the same CPU and ISA.
+// so one binary on a few different machines tunes itself to each of them.
+
+// the file is plain text, one `key=value` on each line. anything else is ignored:
+//     cpu=<the CPUID brand string>
+//     isa=<the ISA the program was compiled for>
+//     table_bits=9
+//     rand_buf_len=128
+//     width=1
+
+// trials for each timed pass. each candidate gets the best of CALIBRATE_REPS passes.
+#if BOARD_SIZE == 8
+	#define CALIBRATE_TRIALS	100000
+#elif BOARD_SIZE == 16
+	#define CALIBRATE_TRIALS	2000
+#else
+	#define CALIBRATE_TRIALS	200
+#endif
+
+#define CALIBRATE_REPS	5
+
+// a candidate has to take at most this much of the time of the current size to replace it.
+// otherwise, the noise would pick a different one every time.
+#define CALIBRATE_MARGIN	0.98
+
+// only the hash table detectors use the table size.
+#define _CALIBRATE_TABLE (SIMD_RUN || CYCLE_DETECT == CYCLE_TABLE || CYCLE_DETECT == CYCLE_SYMMETRY)
+
+#ifdef ISA
+	#define _CALIBRATE_ISA ISA
+#else
+	#define _CALIBRATE_ISA "unknown"
+#endif
+
+static const char *_calibrate_cpu(void) {
+	// the CPUID brand string, like "AMD Ryzen 7 5800X 8-Core Processor".
+	static char name[49] = {0};
+
+	unlikely_if (name[0] == '\0') {
+		u32 *const regs = (u32 *) name;
+
+		for (u8 i = 0; i < 3; i++)
+			__get_cpuid(0x80000002 + i, regs + 4*i, regs + 4*i + 1, regs + 4*i + 2, regs + 4*i + 3);
+
+		// it is padded with spaces, sometimes on the left.
+		char *start = name;
+		while (*start == ' ')
+			start++;
+
+		memmove(name, start, strlen(start) + 1);
+
+		for (u8 i = strlen(name); i > 0 && name[i - 1] == ' '; i--)
+			name[i - 1] = '\0';
+	}
+
+	return name;
+}
+
+static void Calibrate_load(void) {
+	// replaces the compiled sizes with the ones in CALIBFILE, if it is there and for this
+	// machine. a missing file just means it hasn't been calibrated.
+	const u32 fd = _open(CALIBFILE, O_RDONLY | O_BINARY);
+
+	likely_if (fd == ~0u)
+		return;
+
+	char buf[512];
+	const i32 len = _read(fd, buf, sizeof buf - 1);
+	_close(fd);
+
+	unlikely_if (len <= 0)
+		return;
+
+	buf[len] = '\0';
+
+	u32 table_bits = tune.table_bits, rand_buf_len = tune.rand_buf_len, width = tune.width;
+	bool same_cpu = false, same_isa = false;
+
+	for (char *line = buf, *next; line != NULL && *line != '\0'; line = next) {
+		next = strchr(line, '\n');
+
+		if (next != NULL)
+			*next++ = '\0';
+
+		char *const value = strchr(line, '=');
+		if (value == NULL)
+			continue;
+
+		*value = '\0';
+
+		if (streq(line, "cpu"))
+			same_cpu = streq(value + 1, _calibrate_cpu());
+		else if (streq(line, "isa"))
+			same_isa = streq(value + 1, _CALIBRATE_ISA);
+		else if (streq(line, "table_bits"))
+			table_bits = strtoul(value + 1, NULL, 10);
+		else if (streq(line, "rand_buf_len"))
+			rand_buf_len = strtoul(value + 1, NULL, 10);
+		else if (streq(line, "width"))
+			width = strtoul(value + 1, NULL, 10);
+	}
+
+	unlikely_if (!same_cpu || !same_isa) {
+		if (!cfg.quiet)
+			eprintf(CALIBFILE " is for a different %s. run `--calibrate` again to replace it.\n",
+				same_cpu ? "build" : "CPU");
+		return;
+	}
+
+	// RDRAND and COUNTER_RAND don't use the buffer length, so it can be anything.
+	unlikely_if (table_bits < 2 || table_bits > TABLE_BITS_MAX || width < 1 || width > INTERLEAVE_K
+	#if !COUNTER_RAND && RAND_BUF_LEN > 1
+		|| rand_buf_len < 2 || rand_buf_len > 256 || (rand_buf_len & (rand_buf_len - 1)) != 0
+	#endif
+	) {
+		eprintf(CALIBFILE " has sizes this build can't use. run `--calibrate` again to replace it.\n");
+		return;
+	}
+
+	tune.table_bits   = table_bits;
+	tune.rand_buf_len = rand_buf_len;
+	tune.width        = width;
+}
+
+static void _calibrate_reset(void) {
+	// clears what the trials count, so the passes don't end up in the command's summary.
+	memset(data.raw, 0, DATA_SIZE);
+	LongHist_clear();
+
+#if CYCLE_DETECT == CYCLE_SYMMETRY
+	memset(symmetry.tfm_counts, 0, sizeof symmetry.tfm_counts);
+	memset(symmetry.roll_counts, 0, sizeof symmetry.roll_counts);
+#endif
+
+#if MEMO_CACHE
+	// otherwise, the later passes would mostly be memo hits.
+	Memo_reset();
+#endif
+}
+
+static u64 _calibrate_pass(const Board *const restrict states) {
+	// ticks for CALIBRATE_TRIALS trials, the same way nrun runs them. the start states are
+	// random if `states` is NULL.
+	_calibrate_reset();
+
+	i64 start, end;
+	QueryPerformanceCounter(&start);
+
+#if SIMD_RUN
+	simd_run(CALIBRATE_TRIALS, states);
+#else
+#if INTERLEAVE_RUN
+	if (tune.width > 1)
+		ilv_run(CALIBRATE_TRIALS, states);
+	else
+#endif
+	for (u32 i = 0; i < CALIBRATE_TRIALS; i++)
+		run_once(states != NULL ? states[i] : Board_random());
+#endif
+
+	QueryPerformanceCounter(&end);
+	return end - start;
+}
+
+#define CALIBRATE_TABLE_BITS	0
+#define CALIBRATE_RAND_BUF_LEN	1
+#define CALIBRATE_WIDTH			2
+
+static const char *const calibrate_keys[3] = {"table_bits", "rand_buf_len", "width"};
+
+static FORCE_INLINE u32 _calibrate_get(const u8 which) {
+	return which == CALIBRATE_TABLE_BITS ? tune.table_bits :
+		which == CALIBRATE_RAND_BUF_LEN ? tune.rand_buf_len : tune.width;
+}
+
+static FORCE_INLINE void _calibrate_set(const u8 which, const u32 value) {
+	switch (which) {
+	case CALIBRATE_TABLE_BITS:   tune.table_bits   = value; break;
+	case CALIBRATE_RAND_BUF_LEN: tune.rand_buf_len = value; break;
+	case CALIBRATE_WIDTH:        tune.width        = value; break;
+	}
+}
+
+static void _calibrate_pick(
+	const u8 which,
+	const u32 min,
+	const u32 max,
+	const Board *const restrict states,
+	const bool verbose
+) {
+	// times the current value of one of the sizes, and every other one from `min` to `max`
+	// (powers of 2, except for table_bits, which is a log2 already). it is left on the fastest
+	// one, if that beats the current one by CALIBRATE_MARGIN. every round goes through all of
+	// the candidates, so if the machine gets slower for a bit, it isn't just one of them.
+	const u32 current = _calibrate_get(which);
+	u32 values[32] = {current};
+	u64 ticks[32];
+	u8 count = 1;
+
+	for (u32 value = min; value <= max; value = which == CALIBRATE_TABLE_BITS ? value + 1 : value * 2)
+		if (value != current)
+			values[count++] = value;
+
+	memset(ticks, 0xff, sizeof ticks);
+
+	for (u8 rep = 0; rep < CALIBRATE_REPS; rep++) {
+		for (u8 i = 0; i < count; i++) {
+			_calibrate_set(which, values[i]);
+
+			const u64 t = _calibrate_pass(states);
+
+			if (t < ticks[i])
+				ticks[i] = t;
+		}
+	}
+
+	i64 frequency;
+	QueryPerformanceFrequency(&frequency);
+
+	u8 best = 0;
+
+	for (u8 i = 0; i < count; i++) {
+		const double time = (double) ticks[i] / (double) frequency;
+
+		likely_if (verbose)
+			printf("%-13s %-5u %8.3f s  %10.0f trials/sec%s\n", calibrate_keys[which], values[i],
+				time, CALIBRATE_TRIALS / time, i == 0 ? "  (current)" : "");
+
+		if (i != 0 && ticks[i] < ticks[best] * (best == 0 ? CALIBRATE_MARGIN : 1.0))
+			best = i;
+	}
+
+	_calibrate_set(which, values[best]);
+}
+
+static void _calibrate_save(void) {
+	char buf[256];
+	char *p = buf;
+
+	p += sprintf(p, "cpu=%s\n", _calibrate_cpu());
+	p += sprintf(p, "isa=%s\n", _CALIBRATE_ISA);
+
+	for (u8 which = 0; which < 3; which++)
+		p += sprintf(p, "%s=%u\n", calibrate_keys[which], _calibrate_get(which));
+
+	const u32 fd = _open(CALIBFILE, O_CREAT | O_WRONLY | O_TRUNC | O_BINARY, S_IWRITE);
+
+	unlikely_if (fd == ~0u || _write(fd, buf, p - buf) != p - buf) {
+		i32 error; _get_errno(&error);
+		eprintf("can't %s %s: errno=%u.\n", "write", CALIBFILE, error);
+		exit(EXIT_DATAFILE);
+	}
+
+	_close(fd);
+}
+
+static void calibrate(void) {
+	// picks the sizes for this machine, saves them, and leaves them set for the command.
+#if COUNTER_RAND
+	// so `-g` gives the command the same trials with or without this.
+	const u64 counter = rng.counter;
+#endif
+
+	Board *const states = malloc(CALIBRATE_TRIALS * sizeof(Board));
+	OOM(states, 12);
+
+	for (u32 i = 0; i < CALIBRATE_TRIALS; i++)
+		states[i] = Board_random();
+
+	// interesting states would be logged on every pass, which is just noise here.
+	const bool original_quiet = cfg.quiet;
+	const bool verbose = !cfg.quiet;
+	cfg.quiet = true;
+
+	likely_if (verbose)
+		printf("calibrating on %s (ISA=%s), %u trials, best of %u\n", _calibrate_cpu(),
+			_CALIBRATE_ISA, CALIBRATE_TRIALS, CALIBRATE_REPS);
+
+	// fills the attractor cache, so every timed pass sees about the same one.
+	_calibrate_pass(states);
+
+	// the table size and the width are timed on the same start states every time. the
+	// buffer length only matters for new ones, so it uses random ones.
+#if _CALIBRATE_TABLE
+	_calibrate_pick(CALIBRATE_TABLE_BITS, TABLE_BITS_MAX > 7 ? TABLE_BITS_MAX - 5 : 2, TABLE_BITS_MAX, states, verbose);
+#endif
+#if INTERLEAVE_RUN
+	_calibrate_pick(CALIBRATE_WIDTH, 1, INTERLEAVE_K, states, verbose);
+#endif
+#if !COUNTER_RAND && RAND_BUF_LEN > 1
+	_calibrate_pick(CALIBRATE_RAND_BUF_LEN, 2, 256, NULL, verbose);
+#endif
+
+	cfg.quiet = original_quiet;
+	free(states);
+	_calibrate_reset();
+
+#if COUNTER_RAND
+	rng.counter = counter;
+#endif
+
+	_calibrate_save();
+
+	likely_if (!cfg.silent)
+		printf(cfg.quiet ? "%u %u %u\n" : "saved table_bits=%u, rand_buf_len=%u, width=%u to " CALIBFILE "\n",
+			tune.table_bits, tune.rand_buf_len, tune.width);
+}
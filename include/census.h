@@ -0,0 +1,551 @@
+#pragma once
+#define CENSUS_H
+
+// `cens`: the exact functional graph of a small torus. every state is accounted for, so the
+// histograms are the real distributions that `nrun` and `bwrn` estimate with random trials.
+
+// a state of a W by H torus is a u64 with row r in bits r*W to r*W + W - 1, like a Matx8
+// with shorter rows. it is stepped with the same rule macros as Matx8_next, with rolls for
+// the shorter rows.
+
+// the rule commutes with the symmetries of the torus (the translations, and the flips and
+// rotations that map the neighborhood to itself), so every state in an orbit has the same
+// transient, period, and in-degree. only the smallest state of each orbit is run, and it is
+// counted once for each state in the orbit. for 6x6 with MOORE, that is about 2^36 / 288
+// states. most of the others have a row that is smaller than the top row when it is rolled,
+// and that skips every state up to the next value of that row.
+
+// the transient and period come from walking the trajectory with Brent's algorithm, which
+// doesn't need any memory. for the in-degrees, each orbit adds its size to the orbit of its
+// next state, in a hash map keyed by the smallest state of that orbit. a bitmap of every
+// state would be 8 GiB for 6x6, and the map only has the states that have predecessors. it
+// is split into shards with a lock each, so the threads basically never wait on each other.
+
+#include "matx8.h"
+#include "matx8-next.h"
+
+#define CENSUS_MIN 4
+#define CENSUS_MAX 6
+
+#ifndef CENSUS_THREADS
+	// number of threads for `cens`. 0 means one for each logical processor.
+	#define CENSUS_THREADS 0
+#endif
+
+#if CENSUS_THREADS > MAXIMUM_WAIT_OBJECTS
+	#error "CENSUS_THREADS can be at most 64"
+#endif
+
+#define CENSUS_CHUNK_BITS	20  // states per unit of work is 2^this
+#define CENSUS_SHARDS		256 // number of separately locked parts of the in-degree map
+
+typedef struct {
+	u64 *keys;    // state + 1, so 0 is an empty slot
+	u64 *vals;
+	u64 len, mask;
+	u8 lock;
+} __attribute__((aligned(64))) CensusMap;
+
+typedef struct {
+	typeof(data) data; // histograms for this thread's orbits, weighted by the orbit sizes
+	u64 bad;           // 1 + the first state that doesn't fit in the histograms, or 0
+	u32 bad_step, bad_period;
+} CensusWorker;
+
+static struct {
+	u8 w, h, tfms;    // torus size, and the point transforms that are symmetries (see _census_tfm)
+	u32 group;        // number of symmetries, including the translations
+	u64 states;       // 2^(w*h)
+	u64 chunks, next; // number of chunks, and the next one to hand out
+	u8 rowmin[64];    // the smallest rotation of each w-bit row
+	CensusMap map[CENSUS_SHARDS];
+} census = {0};
+
+// rolls, like the Matx8 ones. `x` and `y` are already reduced mod `w` and `h`.
+
+static FORCE_INLINE u64 _census_all(const u8 w, const u8 h) { return ((u64) 1 << w*h) - 1; }
+static FORCE_INLINE u64 _census_lsb(const u8 w, const u8 h) { return _census_all(w, h) / (((u64) 1 << w) - 1); }
+
+static FORCE_INLINE u64 _census_xroll(const u64 state, const u8 x, const u8 w, const u8 h) {
+	if (x == 0)
+		return state;
+
+	const u64 mask = _census_lsb(w, h) * (((u64) 1 << (w - x)) - 1);
+
+	return (state >> x) & mask | (state << (w - x)) & ~mask & _census_all(w, h);
+}
+
+static FORCE_INLINE u64 _census_yroll(const u64 state, const u8 y, const u8 w, const u8 h) {
+	if (y == 0)
+		return state;
+
+	return (state >> y*w | state << (h - y)*w) & _census_all(w, h);
+}
+
+// the rule macros roll by 1 and 7 for +1 and -1 (and 6 for -2), like in board.h.
+// these use the `census_w` and `census_h` from the function they are expanded in.
+#define _CENSUS_XROLL(state, x) _census_xroll(state, (x) < 4 ? (x) : (x) + census_w - 8, census_w, census_h)
+#define _CENSUS_YROLL(state, y) _census_yroll(state, (y) < 4 ? (y) : (y) + census_h - 8, census_w, census_h)
+
+static FORCE_INLINE u64 _census_next(const u64 state, const u8 census_w, const u8 census_h) {
+#if NH_WIDE
+	const u64 next = RULESET_EVAL(u64, _MATX8_NEXT_WIDE, u64, state, _CENSUS_XROLL, _CENSUS_YROLL);
+#else
+	const u64 next = RULESET_EVAL(u64, _MATX8_NEXT_EVAL, COUNTER, u64, NEIGHBORHOOD,
+		state, _CENSUS_XROLL, _CENSUS_YROLL);
+#endif
+
+	// some rulesets turn on the unused bits.
+	return next & _census_all(census_w, census_h);
+}
+
+static FORCE_INLINE u64 _census_tfm(u64 state, const u8 tfm, const u8 w, const u8 h) {
+	// bit 0 flips the rows (TFM_YFLIP), bit 1 flips the columns (TFM_XFLIP), and bit 2
+	// transposes (TFM_TRS), in that order. the transpose is only for square tori.
+	const u64 row = ((u64) 1 << w) - 1, lsb = _census_lsb(w, h);
+	u64 out;
+
+	if (tfm & 1) {
+		out = 0;
+		for (u8 r = 0; r < h; r++)
+			out |= (state >> r*w & row) << (h - 1 - r)*w;
+		state = out;
+	}
+
+	if (tfm & 2) {
+		out = 0;
+		for (u8 c = 0; c < w; c++)
+			out |= (state >> c & lsb) << (w - 1 - c);
+		state = out;
+	}
+
+	if (tfm & 4) {
+		out = 0;
+		for (u8 r = 0; r < h; r++)
+			for (u8 c = 0; c < w; c++)
+				out |= (state >> (r*w + c) & 1) << (c*w + r);
+		state = out;
+	}
+
+	return state;
+}
+
+// the offsets are all in [-2, 2], so the neighborhood fits in a 5x5 bitmask.
+#define _CENSUS_NH_BIT(x, y, ...) | (u32) 1 << (((x) + 2)*5 + (y) + 2)
+
+static u8 _census_symmetries(const u8 w, const u8 h) {
+	// bitmask of the `_census_tfm` transforms that map the neighborhood to itself.
+	const u32 nh = 0 NH_OFFSETS(_CENSUS_NH_BIT, 0);
+	u8 tfms = 0;
+
+	for (u8 tfm = 0; tfm < (w == h ? 8 : 4); tfm++) {
+		u32 image = 0;
+
+		for (i8 x = -2; x <= 2; x++)
+			for (i8 y = -2; y <= 2; y++) {
+				if ((nh >> ((x + 2)*5 + y + 2) & 1) == 0)
+					continue;
+
+				i8 x2 = tfm & 2 ? -x : x, y2 = tfm & 1 ? -y : y;
+
+				if (tfm & 4) {
+					const i8 tmp = x2;
+					x2 = y2;
+					y2 = tmp;
+				}
+
+				image |= (u32) 1 << ((x2 + 2)*5 + y2 + 2);
+			}
+
+		tfms |= (image == nh) << tfm;
+	}
+
+	return tfms;
+}
+
+static FORCE_INLINE bool _census_min(const u64 state, u32 *const restrict stab, const u8 w, const u8 h) {
+	// whether `state` is the smallest state in its orbit. if it is, `stab` is set to the
+	// number of symmetries that don't change it, so the orbit has census.group / stab states.
+	u32 same = 0;
+
+	for (u8 tfm = 0; tfm < 8; tfm++) {
+		if ((census.tfms >> tfm & 1) == 0)
+			continue;
+
+		const u64 p = _census_tfm(state, tfm, w, h);
+
+		for (u8 y = 0; y < h; y++) {
+			const u64 q = _census_yroll(p, y, w, h);
+
+			for (u8 x = 0; x < w; x++) {
+				const u64 r = _census_xroll(q, x, w, h);
+
+				likely_if (r < state)
+					return false;
+
+				same += r == state;
+			}
+		}
+	}
+
+	*stab = same;
+	return true;
+}
+
+static FORCE_INLINE u64 _census_canon(const u64 state, const u8 w, const u8 h) {
+	// the smallest state in the orbit of `state`.
+	u64 min = state;
+
+	for (u8 tfm = 0; tfm < 8; tfm++) {
+		if ((census.tfms >> tfm & 1) == 0)
+			continue;
+
+		const u64 p = _census_tfm(state, tfm, w, h);
+
+		for (u8 y = 0; y < h; y++) {
+			const u64 q = _census_yroll(p, y, w, h);
+
+			for (u8 x = 0; x < w; x++) {
+				const u64 r = _census_xroll(q, x, w, h);
+				min = r < min ? r : min;
+			}
+		}
+	}
+
+	return min;
+}
+
+static FORCE_INLINE u64 _census_hash(const u64 key) {
+	u64 h = (key ^ key >> 31) * 0xbf58476d1ce4e5b9llu;
+	return h ^ h >> 29;
+}
+
+static void _census_map_add(CensusMap *const restrict this, const u64 key, const u64 val) {
+	// adds `val` to the value for `key`. not thread-safe by itself. `key` is already + 1.
+	unlikely_if (4*this->len >= 3*(this->mask + 1)) {
+		// grow to double the size.
+		const u64 old_mask = this->mask, *const old_keys = this->keys, *const old_vals = this->vals;
+
+		this->mask = 2*old_mask + 1;
+		this->keys = calloc(this->mask + 1, sizeof(u64));
+		this->vals = calloc(this->mask + 1, sizeof(u64));
+		OOM(this->keys, 10);
+		OOM(this->vals, 10);
+
+		for (u64 i = 0; i <= old_mask; i++) {
+			if (old_keys[i] == 0)
+				continue;
+
+			u64 j = _census_hash(old_keys[i]) >> 8 & this->mask;
+			while (this->keys[j] != 0)
+				j = j + 1 & this->mask;
+
+			this->keys[j] = old_keys[i];
+			this->vals[j] = old_vals[i];
+		}
+
+		free((u64 *) old_keys);
+		free((u64 *) old_vals);
+	}
+
+	u64 i = _census_hash(key) >> 8 & this->mask;
+
+	while (this->keys[i] != key && this->keys[i] != 0)
+		i = i + 1 & this->mask;
+
+	if (this->keys[i] == 0) {
+		this->keys[i] = key;
+		this->len++;
+	}
+
+	this->vals[i] += val;
+}
+
+static FORCE_INLINE void _census_map_init(CensusMap *const restrict this) {
+	this->len  = 0;
+	this->mask = 1023;
+	this->keys = calloc(this->mask + 1, sizeof(u64));
+	this->vals = calloc(this->mask + 1, sizeof(u64));
+	OOM(this->keys, 10);
+	OOM(this->vals, 10);
+}
+
+static FORCE_INLINE void _census_map_free(CensusMap *const restrict this) {
+	free(this->keys);
+	free(this->vals);
+}
+
+static FORCE_INLINE void _census_indegree_add(const u64 state, const u64 orbit) {
+	// adds the predecessors from an orbit of `orbit` states to the orbit of `state`.
+	const u64 key = state + 1;
+	CensusMap *const shard = &census.map[_census_hash(key) % CENSUS_SHARDS];
+
+	while (__atomic_test_and_set(&shard->lock, __ATOMIC_ACQUIRE))
+		__builtin_ia32_pause();
+
+	_census_map_add(shard, key, orbit);
+
+	__atomic_clear(&shard->lock, __ATOMIC_RELEASE);
+}
+
+static FORCE_INLINE void _census_chunk(
+	CensusWorker *const restrict this,
+	const u64 lo,
+	const u64 hi,
+	const u8 w,
+	const u8 h
+) {
+	// runs the smallest state of every orbit in [lo, hi).
+	const u64 row = ((u64) 1 << w) - 1;
+
+	for (u64 state = lo; state < hi; state++) {
+		// rolling a row to the top, and then rolling it to its smallest rotation, makes a
+		// smaller state when that rotation is less than the top row. the same row fails for
+		// every state until it changes, so skip to its next value. most states stop here.
+		const u64 top = state >> (h - 1)*w;
+		i8 i = h - 1;
+
+		while (i >= 0 && census.rowmin[state >> i*w & row] >= top)
+			i--;
+
+		likely_if (i >= 0) {
+			state |= ((u64) 1 << i*w) - 1;
+			continue;
+		}
+
+		u32 stab;
+
+		likely_if (!_census_min(state, &stab, w, h))
+			continue;
+
+		const u64 orbit = census.group / stab, next = _census_next(state, w, h);
+
+		// Brent's algorithm. first the period, then the transient.
+		u64 tortoise = state, hare = next;
+		u32 power = 1, period = 1;
+
+		while (tortoise != hare) {
+			if (power == period) {
+				tortoise = hare;
+				power *= 2;
+				period = 0;
+			}
+
+			hare = _census_next(hare, w, h);
+			period++;
+		}
+
+		tortoise = hare = state;
+		for (u32 i = 0; i < period; i++)
+			hare = _census_next(hare, w, h);
+
+		// `step` is the index of the first repeated state, like in run.h.
+		u32 step = period;
+
+		while (tortoise != hare) {
+			tortoise = _census_next(tortoise, w, h);
+			hare     = _census_next(hare, w, h);
+			step++;
+		}
+
+		unlikely_if (period > PERIOD_MAX || step > TRANSIENT_MAX) {
+			if (this->bad == 0) {
+				this->bad        = state + 1;
+				this->bad_step   = step;
+				this->bad_period = period;
+			}
+
+			continue;
+		}
+
+		const sttyp_t type = tortoise == 0 ? EMPTY : period == 1 ? CONST : CYCLE;
+
+		this->data.counts[type]     += orbit;
+		this->data.periods[period]  += orbit;
+		this->data.transients[step] += orbit;
+
+		_census_indegree_add(_census_canon(next, w, h), orbit);
+	}
+}
+
+// every size that `cens` accepts. each one gets its own copy of the loop with the
+// size as a constant, so the rolls and masks are all immediates.
+#define _CENSUS_SIZES(X) \
+	X(4, 4) X(4, 5) X(4, 6) \
+	X(5, 4) X(5, 5) X(5, 6) \
+	X(6, 4) X(6, 5) X(6, 6)
+
+#define _CENSUS_CASE(w, h)      case (w) << 4 | (h): _census_chunk(this, lo, hi, w, h); break;
+#define _CENSUS_STAB_CASE(w, h) case (w) << 4 | (h): _census_min(shard->keys[j] - 1, &stab, w, h); break;
+
+static u32 _census_thread(void *const arg) {
+	CensusWorker *const this = arg;
+	const u64 len = census.states < (u64) 1 << CENSUS_CHUNK_BITS ? census.states : (u64) 1 << CENSUS_CHUNK_BITS;
+	u64 chunk;
+
+	while ((chunk = __atomic_fetch_add(&census.next, 1, __ATOMIC_RELAXED)) < census.chunks) {
+		const u64 lo = chunk * len, hi = lo + len;
+
+		switch (census.w << 4 | census.h) {
+			_CENSUS_SIZES(_CENSUS_CASE)
+		default:
+			__builtin_unreachable();
+		}
+	}
+
+	return 0;
+}
+
+typedef struct {
+	u64 indegree, count;
+} CensusHistEntry;
+
+static i32 _census_hist_cmp(const void *const a, const void *const b) {
+	const u64 x = ((const CensusHistEntry *) a)->indegree, y = ((const CensusHistEntry *) b)->indegree;
+	return (x > y) - (x < y);
+}
+
+static char *_census_sprintf_summary(char *buf, const CensusHistEntry *const restrict hist, const u64 len) {
+	// the same object as sprintf_summary, with the in-degrees, and both trial counts as
+	// every state. "board" is "WxH", so analyze.py keeps it separate from the trials.
+	buf += sprintf(buf, "{\n\t\"ruleset\": \"%s\",\n\t\"board\": \"%ux%u\",", ruleset.str, census.w, census.h);
+
+	BUF_WRITE(buf, "\n\t\"hcollide\": {\"count\": 0, \"states\": [\"0x0000000000000000\"]},\n\t\"trials\": [\"");
+	BUF_WRITE(buf, census.states);
+	BUF_WRITE(buf, "\", \"");
+	BUF_WRITE(buf, census.states);
+	BUF_WRITE(buf, "\"],");
+
+	buf = sprintf_summary_hists(buf);
+
+	BUF_WRITE(buf, "\n\t\"indegrees\": {");
+
+	for (u64 i = 0; i < len; i++) {
+		BUF_WRITE(buf, "\"%zu\": %zu", hist[i].indegree, hist[i].count);
+
+		if (i != len - 1)
+			BUF_WRITE(buf, ',', ' ');
+	}
+
+	BUF_WRITE(buf, '}', '\n', '}', '\0');
+
+	return buf - 1; // return a pointer to the null terminator byte.
+}
+
+static void census_run(const u8 w, const u8 h) {
+	// runs every state of the w by h torus, and gives the summary.
+	census.w      = w;
+	census.h      = h;
+	census.tfms   = _census_symmetries(w, h);
+	census.group  = POPCNT(census.tfms) * w * h;
+	census.states = (u64) 1 << w*h;
+	census.chunks = (census.states + ((u64) 1 << CENSUS_CHUNK_BITS) - 1) >> CENSUS_CHUNK_BITS;
+	census.next   = 0;
+
+	for (u8 v = 0; v < 1 << w; v++) {
+		census.rowmin[v] = v;
+
+		for (u8 x = 1; x < w; x++) {
+			const u8 r = (v >> x | v << (w - x)) & ((1 << w) - 1);
+			census.rowmin[v] = r < census.rowmin[v] ? r : census.rowmin[v];
+		}
+	}
+
+	for (u32 i = 0; i < CENSUS_SHARDS; i++)
+		_census_map_init(&census.map[i]);
+
+	u32 threads = CENSUS_THREADS != 0 ? CENSUS_THREADS : GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+	threads = threads > MAXIMUM_WAIT_OBJECTS ? MAXIMUM_WAIT_OBJECTS : threads < 1 ? 1 : threads;
+
+	CensusWorker *const workers = calloc(threads, sizeof(CensusWorker));
+	OOM(workers, 10);
+
+	void *handles[MAXIMUM_WAIT_OBJECTS];
+
+	for (u32 i = 0; i < threads; i++) {
+		handles[i] = CreateThread(NULL, 0, &_census_thread, &workers[i], 0, NULL);
+		OOM(handles[i], 11);
+	}
+
+	if (!cfg.quiet)
+		printf("%ux%u torus, %u threads, %u symmetries\n", w, h, threads, census.group);
+
+	while (WaitForMultipleObjects(threads, handles, true, 1000) == WAIT_TIMEOUT) {
+		likely_if (!cfg.quiet) {
+			const u64 next = __atomic_load_n(&census.next, __ATOMIC_RELAXED);
+			printf("\r%.1f%%\e[K", 100.0 * (next < census.chunks ? next : census.chunks) / census.chunks);
+		}
+	}
+
+	for (u32 i = 0; i < threads; i++)
+		CloseHandle(handles[i]);
+
+	// combine the histograms, and check that everything fit.
+	for (u32 i = 0; i < threads; i++) {
+		unlikely_if (workers[i].bad != 0) {
+			eprintf("\nstate %#zx has period=%u and step=%u. raise PERIOD_LEN or TRANSIENT_LEN.\n",
+				workers[i].bad - 1, workers[i].bad_period, workers[i].bad_step);
+			exit(EXIT_FAILURE);
+		}
+
+		for (u32 j = 0; j < PERIOD_LEN; j++)    data.periods[j]    += workers[i].data.periods[j];
+		for (u32 j = 0; j < TRANSIENT_LEN; j++) data.transients[j] += workers[i].data.transients[j];
+		for (u32 j = 0; j < 3; j++)             data.counts[j]     += workers[i].data.counts[j];
+	}
+
+	free(workers);
+
+	// in-degree histogram. the value for each orbit is the number of predecessors of all of
+	// its states together, and they all have the same number.
+	CensusMap indegrees;
+	_census_map_init(&indegrees);
+
+	u64 reached = 0; // states with at least one predecessor
+
+	for (u32 i = 0; i < CENSUS_SHARDS; i++) {
+		const CensusMap *const shard = &census.map[i];
+
+		for (u64 j = 0; j <= shard->mask; j++) {
+			if (shard->keys[j] == 0)
+				continue;
+
+			// the keys are the smallest states, so this always sets `stab`.
+			u32 stab = 1;
+
+			switch (census.w << 4 | census.h) {
+				_CENSUS_SIZES(_CENSUS_STAB_CASE)
+			default:
+				__builtin_unreachable();
+			}
+
+			const u64 orbit = census.group / stab;
+			reached += orbit;
+			_census_map_add(&indegrees, shard->vals[j] / orbit + 1, orbit);
+		}
+
+		_census_map_free(&census.map[i]);
+	}
+
+	if (reached != census.states)
+		_census_map_add(&indegrees, 0 + 1, census.states - reached); // gardens of eden
+
+	CensusHistEntry *const hist = malloc(indegrees.len * sizeof(CensusHistEntry));
+	OOM(hist, 10);
+
+	u64 len = 0;
+	for (u64 j = 0; j <= indegrees.mask; j++)
+		if (indegrees.keys[j] != 0)
+			hist[len++] = (CensusHistEntry) {indegrees.keys[j] - 1, indegrees.vals[j]};
+
+	_census_map_free(&indegrees);
+	qsort(hist, len, sizeof(CensusHistEntry), &_census_hist_cmp);
+
+	// room for the fixed parts, and about 48 bytes for each histogram entry.
+	char *const buf = malloc(1024 + (PERIOD_LEN + TRANSIENT_LEN + len) * 48);
+	OOM(buf, 10);
+
+	give_summary_buf(buf, _census_sprintf_summary(buf, hist, len), SUM_RETURN);
+
+	free(hist);
+	free(buf);
+}
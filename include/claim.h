@@ -0,0 +1,152 @@
+#pragma once
+#define CLAIM_H
+
+// defines the trial ranges for the summary, and `-p`, which takes them from PERMFILE.
+// requires board.h, and COUNTER_RAND.
+
+// the counter generator (matx8.h) is a bijection from draw numbers to u64s: adding the key
+// and multiplying by an odd number can be undone, and so can every step of the splitmix64
+// finalizer. so the draws of a seed are a permutation of every u64, and no two trials of a
+// seed ever start from the same state, on any board size. that means the part of the space a
+// seed has covered is just the trial numbers it has run, which the summary lists as
+// [first, count] ranges. with `-p`, PERMFILE has the next trial number of each seed that
+// nothing has taken yet, so any number of runs, on any number of machines that share the
+// file, can keep going through the same permutation without running anything twice.
+
+// PERMFILE is one line for each seed, "SEED NEXT" in decimal. the lines are all the same
+// length, so a claim can rewrite its line in place while the file is locked.
+
+#define RAND_WORDS (sizeof(Board) / sizeof(u64)) // draws for each trial
+#define CLAIM_LINE_LEN 42
+#define CLAIM_SLACK 64
+
+typedef struct {
+	u64 first, count;
+} ClaimRange;
+
+static struct {
+	ClaimRange *list; // the ranges that are done, since the summary was last reset
+	u32 len, cap;
+	u64 first;        // the trial the current range started at
+	bool permute;     // whether `-p` was given
+	bool none;        // whether the trials weren't the seed's trial numbers (`nrun strat`)
+} claims = {0};
+
+static FORCE_INLINE u64 _claim_trial(void) {
+	// the trial that the next draw is for.
+	return rng.counter / RAND_WORDS;
+}
+
+static void _claim_push(const u64 first, const u64 count) {
+	unlikely_if (count == 0)
+		return;
+
+	unlikely_if (claims.len == claims.cap) {
+		claims.cap  = claims.cap == 0 ? 8 : 2*claims.cap;
+		claims.list = realloc(claims.list, claims.cap * sizeof(ClaimRange));
+		OOM(claims.list, 15);
+	}
+
+	claims.list[claims.len++] = (ClaimRange) {.first = first, .count = count};
+}
+
+static void Claim_jump(const u64 first) {
+	// ends the current range, and makes the next trial `first`. the same run claiming twice
+	// in a row usually gets the next trials, so then it is still the same range.
+	likely_if (first == _claim_trial())
+		return;
+
+	_claim_push(claims.first, _claim_trial() - claims.first);
+
+	rng.counter  = first * RAND_WORDS;
+	claims.first = first;
+}
+
+static FORCE_INLINE void Claim_reset(void) {
+	// for when `data` is cleared. the ranges start over from the next trial.
+	claims.len   = 0;
+	claims.first = _claim_trial();
+}
+
+static u64 Claim_trials(const u64 n) {
+	// takes the next `n` trials of the seed from PERMFILE, and returns the first one.
+	const i32 fd = _open(PERMFILE, O_CREAT | O_RDWR | O_BINARY, S_IWRITE);
+
+	unlikely_if (fd == -1) {
+		i32 error; _get_errno(&error);
+		eprintf("can't %s %s: errno=%u.\n", "open", PERMFILE, error);
+		exit(EXIT_DATAFILE);
+	}
+
+	// lock starting from byte 0, so only one process reads and writes it at a time.
+	while (_locking(fd, LK_NBLCK, INT32_MAX) != 0) {
+		i32 error; _get_errno(&error);
+
+		if (error != 13 /* EACCES */) {
+			eprintf("can't %s %s: errno=%u.\n", "lock", PERMFILE, error);
+			exit(EXIT_DATAFILE);
+		}
+
+		Sleep(333);
+	}
+
+	char line[CLAIM_LINE_LEN + 1];
+	i64 offset = 0;
+	u64 next   = 0; // a seed that isn't in the file starts at 0
+
+	while (_read(fd, line, CLAIM_LINE_LEN) == CLAIM_LINE_LEN) {
+		line[CLAIM_LINE_LEN] = '\0';
+
+		char *end;
+		const u64 seed = strtoull(line, &end, 10);
+
+		if (seed == rng.seed) {
+			next = strtoull(end, NULL, 10);
+			break;
+		}
+
+		offset += CLAIM_LINE_LEN;
+	}
+
+	// `offset` is the seed's line, or the end of the file if it isn't there.
+	sprintf(line, "%20zu %20zu\n", rng.seed, next + n);
+
+	unlikely_if (_lseeki64(fd, offset, SEEK_SET) != offset || _write(fd, line, CLAIM_LINE_LEN) != CLAIM_LINE_LEN) {
+		i32 error; _get_errno(&error);
+		eprintf("can't %s %s: errno=%u.\n", "write", PERMFILE, error);
+		exit(EXIT_DATAFILE);
+	}
+
+	_close(fd);
+	return next;
+}
+
+static FORCE_INLINE void Claim_next(const u64 n) {
+	// takes `n` more trials for a loop that uses RUN_32. SIMD_RUN and the interleaved engine
+	// keep up to CLAIM_SLACK trials going past the ones that have finished, so it takes that
+	// many more than it runs.
+	Claim_jump(Claim_trials(n + CLAIM_SLACK));
+}
+
+static char *sprintf_summary_ranges(char *buf) {
+	// writes the seed and the ranges of trials since the last reset, with a comma after them.
+	// trials that SIMD_RUN or the interleaved engine started, but that haven't finished yet,
+	// are in the ranges, but not in the rest of the summary.
+	buf += sprintf(buf, "\n\t\"seed\": \"%zu\",", rng.seed);
+
+	unlikely_if (claims.none)
+		return buf;
+
+	buf += sprintf(buf, "\n\t\"ranges\": [");
+
+	for (u32 i = 0; i < claims.len; i++)
+		buf += sprintf(buf, "[\"%zu\", \"%zu\"], ", claims.list[i].first, claims.list[i].count);
+
+	// the current one is left out if it is empty, unless it is the only one.
+	likely_if (claims.len == 0 || _claim_trial() != claims.first)
+		buf += sprintf(buf, "[\"%zu\", \"%zu\"]", claims.first, _claim_trial() - claims.first);
+	else
+		buf -= 2; // the last ", "
+
+	return buf + sprintf(buf, "],");
+}
@@ -0,0 +1,320 @@
+#pragma once
+#define CYCLE_H
+
+// defines the cycle detectors for `run_once` and `sim`, and the Cycle_* API.
+
+// every trial steps a state until it repeats, and the histograms need the exact transient
+// and period. the detectors are given the states one at a time with Cycle_add, and once one
+// of them notices the cycle, Cycle_finish works out the exact first repeat.
+
+// CYCLE_TABLE puts every state in the hash table (table.h), so it notices the first repeat
+// right away, but it costs a hash and a probe for every step, and the table is much bigger
+// than the others. CYCLE_BRENT only keeps one saved state, which it replaces at each power
+// of 2. CYCLE_NIVASCH keeps a stack of the states that are smaller than everything after
+// them, which is usually only a few entries. those two notice the cycle a little late, and
+// step part of the trajectory again to find where it starts.
+
+// CYCLE_SYMMETRY (8x8 only) is the table, but keyed by a fingerprint of the orbit (symmetry.h)
+// instead of the state, so it stops at the first state that is a symmetry of an earlier one.
+// from there on, every state is the same symmetry of the one that many steps before it, so
+// the earlier one is the first state of the cycle, and the period is that many steps times
+// the number of times the symmetry has to be applied to get back to it. that is usually 1,
+// but a glider on its own is a flipped and moved copy of itself every 2 steps, and it only
+// gets back to the same state after 32.
+
+#include "board.h"
+#include "table.h"
+
+#define CYCLE_TABLE		0 // hash table of every state
+#define CYCLE_BRENT		1 // Brent's algorithm
+#define CYCLE_NIVASCH	2 // Nivasch's stack algorithm
+#define CYCLE_SYMMETRY	3 // hash table of every orbit
+
+#ifndef CYCLE_DETECT
+	#define CYCLE_DETECT CYCLE_TABLE
+#endif
+
+#if CYCLE_DETECT != CYCLE_TABLE && CYCLE_DETECT != CYCLE_BRENT && CYCLE_DETECT != CYCLE_NIVASCH && CYCLE_DETECT != CYCLE_SYMMETRY
+	#error "invalid cycle detector. must be CYCLE_TABLE, CYCLE_BRENT, CYCLE_NIVASCH, or CYCLE_SYMMETRY"
+#endif
+
+#if CYCLE_DETECT == CYCLE_SYMMETRY && BOARD_SIZE != 8
+	#pragma message("CYCLE_SYMMETRY only supports 8x8 boards. CYCLE_DETECT=TABLE")
+	#undef CYCLE_DETECT
+	#define CYCLE_DETECT CYCLE_TABLE
+#endif
+
+#if BOARD_SIZE == 8
+	#include "symmetry.h"
+#endif
+
+// return values of Cycle_add. the errors are indices into cycle_errors.
+#define CYCLE_NONE			0 // keep going
+#define CYCLE_FOUND			1 // call Cycle_finish
+#define CYCLE_COLLISION		2
+#define CYCLE_TOO_LONG		3
+
+static const char *const cycle_errors[] = {
+	[CYCLE_COLLISION] = "Fingerprint collision",
+	[CYCLE_TOO_LONG]  = "More than STEP_MAX steps",
+};
+
+// Brent and Nivasch notice the cycle before this step for any trial that fits in the
+// histograms. the trials can go on to STEP_MAX, but the Nivasch stack is only this long,
+// which is plenty, since it almost never has more than a few entries.
+#define CYCLE_STEP_MAX (2*TRANSIENT_LEN + PERIOD_LEN)
+
+typedef struct {
+	Board state;     // Nivasch: the state. Brent: only stack[0] is used, as the saved state.
+	u64 key;         // Board_key of the state
+	u32 step;        // index of the state
+} CycleEntry;
+
+static struct {
+	Board start;     // state 0
+	u32 period;      // set by Cycle_add when it returns CYCLE_FOUND. for CYCLE_SYMMETRY, it is
+	                 // the steps between the two states, until Cycle_finish
+	u32 depth;       // Nivasch: stack length
+	u32 max_depth;   // Nivasch: largest stack length since the last reset, for `bnch cycle`
+	u32 power;       // Brent: steps before the saved state is replaced
+	CycleEntry stack[CYCLE_STEP_MAX + 1];
+#if BOARD_SIZE == 8
+	Symmetry symmetry; // CYCLE_SYMMETRY: maps the earlier state to the one Cycle_add found
+#endif
+} cycle = {0};
+
+// every state of the current trial, by step index, for when the table only has the
+// fingerprints. for CYCLE_TABLE, that is only the bigger boards. the states past
+// TRANSIENT_LEN go on the heap, which grows like the spill table (table.h), and is freed
+// with it, so use Cycle_path_get and Cycle_path_set for them.
+static Board board_path[TRANSIENT_LEN];
+
+static struct {
+	// states TRANSIENT_LEN and up. the bigger boards are AVX vectors, and malloc doesn't
+	// align them, so this is bytes, and they are copied in and out with memcpy.
+	char *states;
+	u32 cap;
+} path_spill = {0};
+
+static FORCE_INLINE Board Cycle_path_get(const u32 step) {
+	likelyp_if (step < TRANSIENT_LEN, 0.9999999)
+		return board_path[step];
+
+	Board state;
+	memcpy(&state, path_spill.states + (step - TRANSIENT_LEN) * sizeof(Board), sizeof(Board));
+	return state;
+}
+
+static FORCE_INLINE void Cycle_path_set(const u32 step, const Board state) {
+	likelyp_if (step < TRANSIENT_LEN, 0.9999999) {
+		board_path[step] = state;
+		return;
+	}
+
+	const u32 i = step - TRANSIENT_LEN;
+
+	unlikely_if (i >= path_spill.cap) {
+		path_spill.cap    = path_spill.cap == 0 ? TRANSIENT_LEN : 2*path_spill.cap;
+		path_spill.states = realloc(path_spill.states, path_spill.cap * sizeof(Board));
+		OOM(path_spill.states, 13);
+	}
+
+	memcpy(path_spill.states + i * sizeof(Board), &state, sizeof(Board));
+}
+
+static FORCE_INLINE void Cycle_clear(const Board start_state, const u8 how) {
+	// `how` is always a constant, so only one of these is compiled for each call.
+	cycle.start = start_state;
+
+	switch (how) {
+	case CYCLE_TABLE:
+	case CYCLE_SYMMETRY:
+		Table_clear();
+
+	#if BOARD_SIZE != 8 || CYCLE_DETECT == CYCLE_SYMMETRY
+		unlikelyp_if (path_spill.states != NULL, 0.9999999) {
+			free(path_spill.states);
+			path_spill = (typeof(path_spill)) {0};
+		}
+	#endif
+		break;
+	case CYCLE_BRENT:
+		cycle.stack[0] = (CycleEntry) {.state = start_state, .step = 0};
+		cycle.power = 1;
+		break;
+	case CYCLE_NIVASCH:
+		cycle.depth = 0;
+		break;
+	}
+}
+
+static FORCE_INLINE u8 _cycle_table_add(const Board state, const u32 step) {
+	const u32 table_value = Table_get_add(Board_key(state), step);
+
+	unlikelyp_if (table_value == TABLE_FULL, 0.9999999)
+		return CYCLE_TOO_LONG;
+
+	unlikelyp_if (table_value != TABLE_NO_VALUE, 0.92129) {
+		// this happens after on average 34.83 iterations., or 2.87% of the time.
+
+	#if BOARD_SIZE != 8
+		// a different state with the same fingerprint. this should basically never happen.
+		unlikely_if (!Board_eq(Cycle_path_get(table_value), state))
+			return CYCLE_COLLISION;
+	#endif
+
+		// the state has already been seen.
+		cycle.period = step - table_value;
+		return CYCLE_FOUND;
+	}
+
+#if BOARD_SIZE != 8
+	Cycle_path_set(step, state);
+#endif
+
+	return CYCLE_NONE;
+}
+
+static FORCE_INLINE u8 _cycle_brent_add(const Board state, const u32 step) {
+	// the saved state is compared to every state after it, until `power` steps have
+	// passed. then the current state is saved instead, and `power` doubles. once the saved
+	// state is on the cycle and `power` is at least the period, it matches.
+	CycleEntry *const saved = &cycle.stack[0];
+
+	unlikelyp_if (step != 0 && Board_eq(saved->state, state), 0.95) {
+		cycle.period = step - saved->step;
+		return CYCLE_FOUND;
+	}
+
+	unlikely_if (step - saved->step == cycle.power) {
+		*saved = (CycleEntry) {.state = state, .step = step};
+		cycle.power *= 2;
+	}
+
+	unlikelyp_if (step == STEP_MAX, 0.9999999)
+		return CYCLE_TOO_LONG;
+
+	return CYCLE_NONE;
+}
+
+static FORCE_INLINE u8 _cycle_nivasch_add(const Board state, const u32 step) {
+	// the stack is strictly increasing, and every entry is smaller than all of the states
+	// after it. the smallest state of the cycle is never popped once it is pushed, so the
+	// cycle is found the next time it comes around, less than two periods after it starts.
+	const u64 key = Board_key(state).matx;
+
+	likelyp_while (cycle.depth != 0 && cycle.stack[cycle.depth - 1].key > key, 0.5)
+		cycle.depth--;
+
+	unlikelyp_if (cycle.depth != 0 && cycle.stack[cycle.depth - 1].key == key, 0.95) {
+		const CycleEntry *const top = &cycle.stack[cycle.depth - 1];
+
+	#if BOARD_SIZE != 8
+		unlikely_if (!Board_eq(top->state, state))
+			return CYCLE_COLLISION;
+	#endif
+
+		cycle.period = step - top->step;
+		return CYCLE_FOUND;
+	}
+
+	unlikelyp_if (step == STEP_MAX || cycle.depth > CYCLE_STEP_MAX, 0.9999999)
+		return CYCLE_TOO_LONG;
+
+	cycle.stack[cycle.depth++] = (CycleEntry) {.state = state, .key = key, .step = step};
+
+	unlikely_if (cycle.depth > cycle.max_depth)
+		cycle.max_depth = cycle.depth;
+
+	return CYCLE_NONE;
+}
+
+#if BOARD_SIZE == 8
+static FORCE_INLINE u8 _cycle_symmetry_add(const Board state, const u32 step) {
+	// a different orbit with the same fingerprint moves on to the next key, so every orbit
+	// gets its own key, and a matching key is an orbit the trial has already been in.
+	for (u64 key = Symmetry_key(state);; key += 0x9e3779b97f4a7c15llu) {
+		const u32 table_value = Table_get_add((Matx8) {.matx = key}, step);
+
+		unlikelyp_if (table_value == TABLE_FULL, 0.9999999)
+			return CYCLE_TOO_LONG;
+
+		likelyp_if (table_value == TABLE_NO_VALUE, 0.92129)
+			break;
+
+		likelyp_if (Symmetry_find(Cycle_path_get(table_value), state, &cycle.symmetry), 0.99) {
+			cycle.period = step - table_value;
+			return CYCLE_FOUND;
+		}
+	}
+
+	Cycle_path_set(step, state);
+
+	return CYCLE_NONE;
+}
+#endif
+
+static FORCE_INLINE u8 Cycle_add(const Board state, const u32 step, const u8 how) {
+	// `state` is state number `step`. they have to be given in order, starting at 0.
+	switch (how) {
+	case CYCLE_TABLE:   return _cycle_table_add(state, step);
+	case CYCLE_BRENT:   return _cycle_brent_add(state, step);
+	case CYCLE_NIVASCH: return _cycle_nivasch_add(state, step);
+#if BOARD_SIZE == 8
+	case CYCLE_SYMMETRY: return _cycle_symmetry_add(state, step);
+#endif
+	default: __builtin_unreachable();
+	}
+}
+
+static FORCE_INLINE u32 Cycle_finish(Board *const restrict state, u32 step, const u8 how) {
+	// call after Cycle_add returns CYCLE_FOUND for state number `step`. returns the index of
+	// the first repeated state (the transient plus the period), and sets `state` to it.
+	if (how == CYCLE_TABLE)
+		return step; // the table always finds the first repeat.
+
+#if BOARD_SIZE == 8
+	if (how == CYCLE_SYMMETRY) {
+		// the earlier state is the first state of the cycle. the symmetry is at most order 32
+		// (a transform of order 4, then a roll of order 8), so this never takes long.
+		const u32 first = step - cycle.period;
+		const Board start = Cycle_path_get(first);
+		Board image = Symmetry_apply(start, cycle.symmetry);
+		u32 order = 1;
+
+		likely_until (Board_eq(image, start)) {
+			image = Symmetry_apply(image, cycle.symmetry);
+			order++;
+		}
+
+		cycle.period *= order;
+		*state = start;
+		return first + cycle.period;
+	}
+#endif
+
+	// a state from before the cycle, and the one a period after it. step both of them until
+	// they meet, and that is the start of the cycle. for Nivasch, the entry under the top of
+	// the stack is smaller than every state of the cycle, so it is before the cycle.
+	Board tortoise = cycle.start;
+	step = 0;
+
+	if (how == CYCLE_NIVASCH && cycle.depth > 1) {
+		tortoise = cycle.stack[cycle.depth - 2].state;
+		step     = cycle.stack[cycle.depth - 2].step;
+	}
+
+	Board hare = tortoise;
+
+	for (u32 i = 0; i < cycle.period; i++)
+		hare = Board_next(hare);
+
+	likely_until (Board_eq(tortoise, hare)) {
+		tortoise = Board_next(tortoise);
+		hare     = Board_next(hare);
+		step++;
+	}
+
+	*state = tortoise;
+	return step + cycle.period;
+}
@@ -0,0 +1,158 @@
+#pragma once
+#define INFER_H
+
+// `infr`: finds every outer-totalistic ruleset that steps A1 to A2, A2 to A3, and so on.
+
+// each cell of a transition forces one bit of the truth table: the next state of a cell
+// with its state and neighbor count has to be the cell in the next board. the counts come
+// from the same counter planes as Matx8_next, so all 64 cells are done at once, and each
+// bit is forced by a whole mask of cells. the forced bits from all of the transitions are
+// combined, and every ruleset that matches them is consistent with the sequence.
+
+// the rulesets here are 18 bits, with bit s * 9 + n for a cell with state s and n neighbors,
+// because 0 and 8 can be told apart here. the counters can't tell them apart though, so the
+// rulesets where they are different can't be run with -r. only the 3x3 neighborhoods without
+// the center are checked, so quiet mode doesn't print anything for the wide ones.
+
+#include "matx8.h"
+#include "matx8-next.h"
+
+#define _INFER_CARE(nh) ((nh) == NH_MOORE ? 0x3FFFFu : 0x3E1Fu)
+
+typedef struct {
+	u32 one, zero; // truth table bits that are forced to be 1 or 0
+	u32 bad;       // index of the first transition that contradicts an earlier one, or 0
+} Infer;
+
+static FORCE_INLINE void _infer_transition(Infer *const restrict this, const u64 a, const u64 b, const u8 nh) {
+	const u64
+		xl = Matx8__xroll_u(a, 7),
+		xr = Matx8__xroll_u(a, 1),
+		ul = Matx8__yroll_u(xl, 7), uc = Matx8__yroll_u(a, 7), ur = Matx8__yroll_u(xr, 7),
+		cl = xl,                                               cr = xr,
+		dl = Matx8__yroll_u(xl, 1), dc = Matx8__yroll_u(a, 1), dr = Matx8__yroll_u(xr, 1),
+		_0 = 0;
+
+	u64 n2, n1, n0, n8 = 0;
+
+	// `nh` is always a constant, so only one of these is compiled for each call.
+	if (nh == NH_MOORE) {
+		COUNTER(u64, NH_MOORE, n2, n1, n0, ul, uc, ur, cl, cr, dl, dc, dr);
+		n8 = ul & uc & ur & cl & cr & dl & dc & dr; // the counter wraps this one to 0
+	}
+	else if (nh == NH_VON_NEUMANN)
+		COUNTER(u64, NH_VON_NEUMANN, n2, n1, n0, _0, uc, _0, cl, cr, _0, dc, _0);
+	else
+		COUNTER(u64, NH_DIAGONAL, n2, n1, n0, ul, _0, ur, _0, _0, dl, _0, dr);
+
+	for (u8 n = 0; n <= 8; n++) {
+		// the cells with exactly n neighbors.
+		u64 cells = n == 8 ? n8 :
+			~(n0 ^ -(u64) (n >> 0 & 1)) &
+			~(n1 ^ -(u64) (n >> 1 & 1)) &
+			~(n2 ^ -(u64) (n >> 2 & 1)) & ~n8;
+
+		if (cells == 0)
+			continue;
+
+		for (u8 s = 0; s < 2; s++) {
+			const u64 m = cells & (s ? a : ~a);
+			const u32 bit = 1u << (s * 9 + n);
+
+			if ((m &  b) != 0) this->one  |= bit;
+			if ((m & ~b) != 0) this->zero |= bit;
+		}
+	}
+}
+
+static Infer infer(const Matx8 *const restrict states, const u32 count, const u8 nh) {
+	// the forced bits for the sequence `states` with the neighborhood `nh`.
+	Infer this = {0};
+
+	for (u32 i = 1; i < count; i++) {
+		switch (nh) {
+		case NH_MOORE:       _infer_transition(&this, states[i - 1].matx, states[i].matx, NH_MOORE); break;
+		case NH_VON_NEUMANN: _infer_transition(&this, states[i - 1].matx, states[i].matx, NH_VON_NEUMANN); break;
+		default:             _infer_transition(&this, states[i - 1].matx, states[i].matx, NH_DIAGONAL); break;
+		}
+
+		unlikely_if ((this.one & this.zero) != 0) {
+			this.bad = i;
+			break;
+		}
+	}
+
+	return this;
+}
+
+static char *infer_sprint(char *restrict buf, const u32 rule, const u8 nh) {
+	// writes the 18-bit ruleset as `B.../S...`. returns a pointer to the null terminator.
+	const u8 max_count = nh == NH_MOORE ? 8 : 4;
+
+	for (u8 part = 0; part < 2; part++) {
+		*buf++ = "BS"[part];
+
+		for (u8 n = 0; n <= max_count; n++)
+			if (rule >> (part * 9 + n) & 1)
+				*buf++ = '0' + n;
+
+		*buf++ = "/"[part];
+	}
+
+	return buf - 1;
+}
+
+static void infer_print(const Matx8 *const restrict states, const u32 count) {
+	// prints the consistent rulesets for every neighborhood. in quiet mode, it only prints
+	// the ones that can be run for the compiled neighborhood, so they can be given to `swep`.
+	static const char *const nh_names[3] = {"MOORE", "VON_NEUMANN", "DIAGONAL"};
+
+	if (cfg.silent)
+		return;
+
+	for (u8 nh = 0; nh < 3; nh++) {
+		if (cfg.quiet && nh != NEIGHBORHOOD)
+			continue;
+
+		const Infer this = infer(states, count, nh);
+		const u32 care = _INFER_CARE(nh), free = care & ~(this.one | this.zero);
+
+		if (this.bad != 0) {
+			if (!cfg.quiet)
+				printf("%s: 0 rulesets. state %u contradicts the earlier states.\n",
+					nh_names[nh], this.bad + 1);
+
+			continue;
+		}
+
+		if (!cfg.quiet) {
+			char forced[24], unknown[24];
+			infer_sprint(forced, this.one, nh);
+			infer_sprint(unknown, free, nh);
+
+			printf("%s: %u ruleset%s. forced: %s, unknown: %s\n", nh_names[nh],
+				1u << POPCNT(free), "s" + (free == 0), forced, unknown);
+		}
+
+		// every subset of the free bits, in increasing order.
+		u32 sub = 0;
+		do {
+			const u32 rule = this.one | sub;
+			sub = (sub - free) & free;
+
+			// 0 and 8 neighbors are the same for the counters.
+			const bool runnable = nh != NH_MOORE || ((rule ^ rule >> 8) & 0x201) == 0;
+
+			if (cfg.quiet && !runnable)
+				continue;
+
+			char buf[24];
+			infer_sprint(buf, rule, nh);
+
+			if (cfg.quiet)
+				puts(buf);
+			else
+				printf("    %s%s\n", buf, runnable ? "" : " (0 != 8, can't be run)");
+		} while (sub != 0);
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+#define MATX8_BITSLICE_H
+
+// steps 64 boards at once in the bit-sliced form from Matx8_slice.
+
+// in this form, each row of 8 cells is split into 8/SIMD_LANES vectors, so the x
+// rolls are lane rotations across the parts of a row, and the y rolls are just using
+// a different row. there is no shifting or masking, and one evaluation of the rule
+// does SIMD_LANES cells of all 64 boards. it only pays off when the boards are
+// stepped a fixed number of times, because there is no way to stop one board early,
+// and the transposes aren't free.
+
+#include "matx8.h"
+#include "matx8-next.h"
+#include "matx8-simd.h" // u64xN
+
+#if !NH_WIDE
+#define _MATX8X64_PARTS (8 / SIMD_LANES) // vectors per row
+
+// shuffle masks for the x rolls of one part. the first operand is the part itself, and
+// the second one is the part before it for a left roll, or after it for a right roll.
+// lane c <- lane c - 1 or lane c + 1, the same direction as Matx8__xroll_u(s, 7) and (s, 1).
+#if SIMD_LANES == 8
+	#define _MATX8X64_XL_MASK {15, 0, 1, 2, 3, 4, 5, 6}
+	#define _MATX8X64_XR_MASK {1, 2, 3, 4, 5, 6, 7, 8}
+#elif SIMD_LANES == 4
+	#define _MATX8X64_XL_MASK {7, 0, 1, 2}
+	#define _MATX8X64_XR_MASK {1, 2, 3, 4}
+#else
+	#define _MATX8X64_XL_MASK {3, 0}
+	#define _MATX8X64_XR_MASK {1, 2}
+#endif
+
+#define _MATX8X64_XL(row, p) __builtin_shuffle((row)[p], \
+	(row)[((p) + _MATX8X64_PARTS - 1) % _MATX8X64_PARTS], (u64xN) _MATX8X64_XL_MASK)
+#define _MATX8X64_XR(row, p) __builtin_shuffle((row)[p], \
+	(row)[((p) + 1) % _MATX8X64_PARTS], (u64xN) _MATX8X64_XR_MASK)
+
+static void Matx8x64_next(Matx8x64 *const restrict next, const Matx8x64 *const restrict this) {
+	const u64xN *const rows = (const u64xN *) this->cells;
+	u64xN *const out = (u64xN *) next->cells;
+
+	for (u8 r = 0; r < 8; r++) {
+		const u64xN
+			*const u = rows + _MATX8X64_PARTS*(r - 1 & 7), // up
+			*const c = rows + _MATX8X64_PARTS*r,           // center
+			*const d = rows + _MATX8X64_PARTS*(r + 1 & 7); // down
+
+		for (u8 p = 0; p < _MATX8X64_PARTS; p++) {
+			out[_MATX8X64_PARTS*r + p] = RULESET_EVAL(u64xN, _MATX8_RULE_EVAL, COUNTER,
+				u64xN, NEIGHBORHOOD, c[p],
+				_MATX8X64_XL(u, p), u[p], _MATX8X64_XR(u, p),
+				_MATX8X64_XL(c, p),       _MATX8X64_XR(c, p),
+				_MATX8X64_XL(d, p), d[p], _MATX8X64_XR(d, p)
+			);
+		}
+	}
+}
+
+static void Matx8x64_nextn(Matx8x64 *const restrict this, u64 n) {
+	// step every board `n` times in place.
+	Matx8x64 tmp;
+
+	for (; n >= 2; n -= 2) {
+		Matx8x64_next(&tmp, this);
+		Matx8x64_next(this, &tmp);
+	}
+
+	if (n != 0) {
+		Matx8x64_next(&tmp, this);
+		*this = tmp;
+	}
+}
+
+#endif // !NH_WIDE
+
+static void Matx8_nextn_many(Matx8 *const restrict boards, const u64 count, const u64 n) {
+	// step each of the `count` boards `n` times in place, 64 at a time.
+	// the last group is padded with empty boards.
+#if KERNEL == KERNEL_LUT
+	// the bit-sliced form only works with the ruleset conditions, which may not be the same rule.
+	Matx8_nextn_many_lut(boards, count, n);
+#elif NH_WIDE
+	// the lane shuffles only reach one cell over, so the wide neighborhoods step one at a time.
+	for (u64 i = 0; i < count; i++)
+		for (u64 j = 0; j < n; j++)
+			boards[i] = Matx8_next(boards[i]);
+#else
+	Matx8x64 sliced;
+
+	for (u64 i = 0; i < count; i += 64) {
+		const u64 len = count - i < 64 ? count - i : 64;
+
+		likely_if (len == 64)
+			Matx8_slice(&sliced, boards + i);
+		else {
+			Matx8 tmp[64] = {0};
+			memcpy(tmp, boards + i, len * sizeof(Matx8));
+			Matx8_slice(&sliced, tmp);
+		}
+
+		Matx8x64_nextn(&sliced, n);
+
+		likely_if (len == 64)
+			Matx8_unslice(boards + i, &sliced);
+		else {
+			Matx8 tmp[64];
+			Matx8_unslice(tmp, &sliced);
+			memcpy(boards + i, tmp, len * sizeof(Matx8));
+		}
+	}
+#endif
+}
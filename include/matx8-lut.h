@@ -0,0 +1,280 @@
+#pragma once
+#define MATX8_LUT_H
+
+// row lookup table kernel. each next row is one load from a table indexed by the row
+// above, the row itself, and the row below (24 bits), so it works for any rule on the
+// 3x3 neighborhood, including non-totalistic (Hensel notation) rules, and the cost
+// doesn't depend on the rule at all. the table is 16 MiB though, so random states miss
+// the cache on most rows, and it is only faster than NEXT_COND for rules that take a
+// lot of operations. `bnch lut` compares the two.
+
+// NOTE: the directions here are the ones `print_state` shows, so north is row r + 1
+//       and west is column c + 1. this only matters for anisotropic (MAP) rules.
+
+#include "matx8.h"
+#include "matx8-next.h" // NH_*, _MATX8_RULE
+
+// a rule on the 3x3 neighborhood. bit p is the next state of a cell with neighborhood p,
+// where the bits of p are NW, N, NE, W, C, E, SW, S, SE, from bit 8 down to bit 0.
+// this is the same order as the bits in Golly's MAP rules.
+typedef struct {
+	u64 bits[8];
+} Rule3x3;
+
+#define RULE3X3_CENTER		0x010 // C
+#define RULE3X3_MOORE		0x1EF // every cell except C
+#define RULE3X3_VON_NEUMANN	0x0AA // N, W, E, S
+#define RULE3X3_DIAGONAL	0x145 // NW, NE, SW, SE
+
+static u8 Matx8_row_lut[1 << 24];
+
+static FORCE_INLINE bool Rule3x3_get(const Rule3x3 *const restrict this, const u16 p) {
+	return this->bits[p >> 6] >> (p & 63) & 1;
+}
+
+static FORCE_INLINE void Rule3x3_set(Rule3x3 *const restrict this, const u16 p) {
+	this->bits[p >> 6] |= 1llu << (p & 63);
+}
+
+static Rule3x3 Rule3x3_from_cond(const u8 nh) {
+	// the rule that NEXT_COND gives for the neighborhood `nh`.
+	// _MATX8_RULE's ul is row r - 1 and column c - 1, which is SE (bit 0) here.
+	Rule3x3 rule = {0};
+
+	for (u16 p = 0; p < 512; p++) {
+		#define B(i) -(u64) (p >> (i) & 1)
+		if (_MATX8_RULE(u64, nh, B(4), B(0), B(1), B(2), B(3), B(5), B(6), B(7), B(8)) & 1)
+			Rule3x3_set(&rule, p);
+		#undef B
+	}
+
+	return rule;
+}
+
+static Rule3x3 Rule3x3_from_tt(const u16 tt, const u8 nh) {
+	// the outer-totalistic rule with the truth table `tt` (see ruleset.h).
+	const u16 mask = nh == NH_MOORE ? RULE3X3_MOORE :
+		nh == NH_VON_NEUMANN ? RULE3X3_VON_NEUMANN : RULE3X3_DIAGONAL;
+	Rule3x3 rule = {0};
+
+	for (u16 p = 0; p < 512; p++)
+		if (tt >> (!!(p & RULE3X3_CENTER) << 3 | (__builtin_popcount(p & mask) & 7)) & 1)
+			Rule3x3_set(&rule, p);
+
+	return rule;
+}
+
+// Hensel notation. these are one neighborhood for each letter, and the rest of them are
+// the rotations and reflections. the bits are NW, N, NE, W, C, E, SW, S, SE from bit 0
+// up, which is this order rotated 180 degrees, so it gives the same classes.
+// counts 5 to 8 use the complement of the neighborhood with 8 - count and the same letter.
+static const char *const hensel_letters[5] = {"", "ce", "ceaikn", "ceaiknjqry", "ceaiknjqrtwyz"};
+static const u16 hensel_codes[5][13] = {
+	{0},
+	{1, 2},
+	{5, 10, 3, 40, 33, 68},
+	{69, 42, 11, 7, 98, 13, 14, 70, 41, 97},
+	{325, 170, 15, 45, 99, 71, 106, 102, 43, 101, 105, 78, 108},
+};
+
+static u16 _Rule3x3_sym(const u16 p, const u8 sym) {
+	// sym bit 0: x flip, bit 1: y flip, bit 2: transpose
+	u16 out = 0;
+
+	for (u8 i = 0; i < 9; i++) {
+		u8 y = i / 3, x = i % 3;
+
+		if (sym & 1) x = 2 - x;
+		if (sym & 2) y = 2 - y;
+		if (sym & 4) { const u8 tmp = x; x = y; y = tmp; }
+
+		out |= (p >> i & 1) << (3*y + x);
+	}
+
+	return out;
+}
+
+static u8 _Rule3x3_letter(u16 p) {
+	// index of the Hensel letter of the neighbors in `p`. 0 for counts 0 and 8.
+	p &= RULE3X3_MOORE;
+	u8 count = __builtin_popcount(p);
+
+	if (count > 4) {
+		p = ~p & RULE3X3_MOORE;
+		count = 8 - count;
+	}
+
+	for (u8 letter = 0; hensel_letters[count][letter] != '\0'; letter++)
+		for (u8 sym = 0; sym < 8; sym++)
+			if (_Rule3x3_sym(hensel_codes[count][letter], sym) == p)
+				return letter;
+
+	return 0;
+}
+
+static const char *_Rule3x3_parse_map(Rule3x3 *const restrict out, const char *restrict str) {
+	// Golly MAP rule. 512 bits of base64, most significant bit first.
+	memset(out, 0, sizeof *out);
+
+	for (u16 p = 0; p < 512; p += 6, str++) {
+		const char c = *str;
+		u8 v;
+
+		if      (c >= 'A' && c <= 'Z') v = c - 'A';
+		else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+		else if (c >= '0' && c <= '9') v = c - '0' + 52;
+		else if (c == '+') v = 62;
+		else if (c == '/') v = 63;
+		else return "MAP rules need 86 base64 characters";
+
+		for (u8 i = 0; i < 6 && p + i < 512; i++)
+			if (v >> (5 - i) & 1)
+				Rule3x3_set(out, p + i);
+	}
+
+	while (*str == '=')
+		str++;
+
+	return *str == '\0' ? NULL : "MAP rules need 86 base64 characters";
+}
+
+static const char *Rule3x3_parse(Rule3x3 *const restrict out, const char *restrict str, const u8 nh) {
+	// parses `B.../S...` in either order, with optional Hensel letters for NH_MOORE
+	// (e.g. `B2-a3/S12`), or a Golly MAP rule. returns an error message, or NULL.
+	if (str[0] == 'M' && str[1] == 'A' && str[2] == 'P')
+		return _Rule3x3_parse_map(out, str + 3);
+
+	const u16 mask = nh == NH_MOORE ? RULE3X3_MOORE :
+		nh == NH_VON_NEUMANN ? RULE3X3_VON_NEUMANN : RULE3X3_DIAGONAL;
+	const u8 max_count = __builtin_popcount(mask);
+
+	// allowed letters for each count, for birth (0) and survival (1).
+	u16 letters[2][9] = {0};
+	bool seen[2] = {false, false};
+
+	while (*str != '\0') {
+		const u8 part = *str == 'S' || *str == 's';
+
+		unlikely_if (!part && *str != 'B' && *str != 'b')
+			return "expected `B` or `S`";
+
+		unlikely_if (seen[part])
+			return "`B` or `S` given twice";
+
+		seen[part] = true;
+		str++;
+
+		while (*str >= '0' && *str <= '9') {
+			const u8 count = *str++ - '0';
+
+			unlikely_if (count > max_count)
+				return "neighbor count is too large for the neighborhood";
+
+			const bool negate = *str == '-';
+			str += negate;
+
+			u16 given = 0;
+
+			while (*str >= 'a' && *str <= 'z') {
+				unlikely_if (nh != NH_MOORE)
+					return "Hensel letters need the Moore neighborhood";
+
+				const char *const valid = hensel_letters[count > 4 ? 8 - count : count];
+				const char *const letter = strchr(valid, *str++);
+
+				unlikely_if (letter == NULL)
+					return "invalid Hensel letter for the neighbor count";
+
+				given |= 1u << (letter - valid);
+			}
+
+			letters[part][count] = given == 0 ? UINT16_MAX : negate ? ~given : given;
+		}
+
+		if (*str == '/')
+			str++;
+	}
+
+	memset(out, 0, sizeof *out);
+
+	for (u16 p = 0; p < 512; p++) {
+		const u16 allowed = letters[!!(p & RULE3X3_CENTER)][__builtin_popcount(p & mask)];
+
+		if (allowed >> (nh == NH_MOORE ? _Rule3x3_letter(p) : 0) & 1)
+			Rule3x3_set(out, p);
+	}
+
+	return NULL;
+}
+
+static void Matx8_lut_init(const Rule3x3 rule) {
+	// fills the row table for `rule`. the index is north << 16 | center << 8 | south,
+	// and bit c of the output only depends on bits c - 1 to c + 1 of each input row.
+	for (u32 nc = 0; nc < 1 << 16; nc++) {
+		u16 upper[8]; // the north and center parts of the neighborhood of each column
+		const u32 n = nc >> 8, c = nc & 255;
+		const u32 n3 = n | n << 8 | n << 16, c3 = c | c << 8 | c << 16;
+
+		for (u8 x = 0; x < 8; x++)
+			upper[x] = (n3 >> (x + 7) & 7) << 6 | (c3 >> (x + 7) & 7) << 3;
+
+		for (u32 s = 0; s < 256; s++) {
+			const u32 s3 = s | s << 8 | s << 16;
+			u8 row = 0;
+
+			for (u8 x = 0; x < 8; x++)
+				row |= Rule3x3_get(&rule, upper[x] | (s3 >> (x + 7) & 7)) << x;
+
+			Matx8_row_lut[nc << 8 | s] = row;
+		}
+	}
+}
+
+static void Matx8_lut_init_default(void) {
+	// the runtime ruleset if it is given with `-r`, otherwise LUT_RULE if it is given,
+	// otherwise the same rule as NEXT_COND. NOTE: Ruleset_set has to be called first.
+#ifdef LUT_RULE
+	Rule3x3 rule;
+
+	if (!ruleset.given) {
+		const char *const error = Rule3x3_parse(&rule, LUT_RULE, NEIGHBORHOOD);
+
+		unlikely_if (error != NULL) {
+			eprintf("invalid LUT_RULE \"%s\": %s\n", LUT_RULE, error);
+			exit(EXIT_FAILURE);
+		}
+	}
+	else
+		rule = Rule3x3_from_tt(ruleset.tt, NEIGHBORHOOD);
+#else
+	const Rule3x3 rule = Rule3x3_from_tt(ruleset.tt, NEIGHBORHOOD);
+#endif
+
+	Matx8_lut_init(rule);
+}
+
+static FORCE_INLINE Matx8 Matx8__next_lut(const Matx8 this) {
+	Matx8 next;
+
+	for (u8 r = 0; r < 8; r++)
+		next.rows[r] = Matx8_row_lut[
+			(u32) this.rows[r + 1 & 7] << 16 | (u32) this.rows[r] << 8 | this.rows[r - 1 & 7]
+		];
+
+	return next;
+}
+
+static void Matx8_nextn_many_lut(Matx8 *const restrict boards, const u64 count, const u64 n) {
+	// step each of the `count` boards `n` times in place. the table is too big for the
+	// caches, so this steps 8 boards in between each other to have more loads in flight.
+	u64 i = 0;
+
+	for (; i + 8 <= count; i += 8)
+		for (u64 j = 0; j < n; j++)
+			for (u8 k = 0; k < 8; k++)
+				boards[i + k] = Matx8__next_lut(boards[i + k]);
+
+	for (; i < count; i++)
+		for (u64 j = 0; j < n; j++)
+			boards[i] = Matx8__next_lut(boards[i]);
+}
@@ -4,13 +4,32 @@
 #define NH_MOORE		0 // 8 neighbors (combination of the other two)
 #define NH_VON_NEUMANN	1 // 4 neighbors (cardinal directions)
 #define NH_DIAGONAL		2 // 4 neighbors (only the diagonal ones)
+#define NH_HEX			3 // 6 neighbors (moore without the up right and down left corners)
+#define NH_KNIGHT		4 // 8 neighbors (chess knight moves)
+#define NH_MOORE2		5 // 24 neighbors (5x5 square)
+#define NH_VON_NEUMANN2	6 // 12 neighbors (manhattan distance of at most 2)
 
-#ifndef NEXT_COND
-	// NOTE: 0 and 8 are always the same, so not all conditions are allowed.
-
-	#pragma message("NEXT_COND not given. assuming B3/S23.")
-	#define NEXT_COND ~n2 & n1 & (n0 | s)
-#endif
+// every neighborhood as a list of (x, y) offsets from the center cell. -1 is left or up.
+// `X(x, y, ...)` is expanded once for each neighbor, with the extra arguments passed
+// through. the wide kernel and the backwards search are both generated from these.
+#define _NH_OFFSETS_VON_NEUMANN(X, ...) \
+	X( 0, -1, __VA_ARGS__) X(-1,  0, __VA_ARGS__) X( 1,  0, __VA_ARGS__) X( 0,  1, __VA_ARGS__)
+#define _NH_OFFSETS_DIAGONAL(X, ...) \
+	X(-1, -1, __VA_ARGS__) X( 1, -1, __VA_ARGS__) X(-1,  1, __VA_ARGS__) X( 1,  1, __VA_ARGS__)
+#define _NH_OFFSETS_MOORE(X, ...) \
+	_NH_OFFSETS_VON_NEUMANN(X, __VA_ARGS__) _NH_OFFSETS_DIAGONAL(X, __VA_ARGS__)
+#define _NH_OFFSETS_HEX(X, ...) \
+	_NH_OFFSETS_VON_NEUMANN(X, __VA_ARGS__) X(-1, -1, __VA_ARGS__) X( 1,  1, __VA_ARGS__)
+#define _NH_OFFSETS_KNIGHT(X, ...) \
+	X(-1, -2, __VA_ARGS__) X( 1, -2, __VA_ARGS__) X(-2, -1, __VA_ARGS__) X( 2, -1, __VA_ARGS__) \
+	X(-2,  1, __VA_ARGS__) X( 2,  1, __VA_ARGS__) X(-1,  2, __VA_ARGS__) X( 1,  2, __VA_ARGS__)
+#define _NH_OFFSETS_VON_NEUMANN2(X, ...) \
+	_NH_OFFSETS_MOORE(X, __VA_ARGS__) \
+	X( 0, -2, __VA_ARGS__) X(-2,  0, __VA_ARGS__) X( 2,  0, __VA_ARGS__) X( 0,  2, __VA_ARGS__)
+#define _NH_OFFSETS_MOORE2(X, ...) \
+	_NH_OFFSETS_MOORE(X, __VA_ARGS__) _NH_OFFSETS_KNIGHT(X, __VA_ARGS__) \
+	X( 0, -2, __VA_ARGS__) X(-2,  0, __VA_ARGS__) X( 2,  0, __VA_ARGS__) X( 0,  2, __VA_ARGS__) \
+	X(-2, -2, __VA_ARGS__) X( 2, -2, __VA_ARGS__) X(-2,  2, __VA_ARGS__) X( 2,  2, __VA_ARGS__)
 
 #ifndef NEIGHBORHOOD
 	#pragma message("NEIGHBORHOOD not given. assuming NH_MOORE (8 neighbors).")
@@ -21,13 +40,114 @@
 	#endif
 #endif
 
+#ifndef NH_CENTER
+	// true  => a cell counts as one of its own neighbors when it is alive.
+	// false => it doesn't.
+	#define NH_CENTER false
+#endif
+
+// NH_OFFSETS is the offset list, NH_NEIGHBORS is its length, and NH_NAME is for the summary.
+#if NEIGHBORHOOD == NH_MOORE
+	#define NH_OFFSETS		_NH_OFFSETS_MOORE
+	#define NH_NAME			"MOORE"
+	#define NH_NEIGHBORS	8
+#elif NEIGHBORHOOD == NH_VON_NEUMANN
+	#define NH_OFFSETS		_NH_OFFSETS_VON_NEUMANN
+	#define NH_NAME			"VON_NEUMANN"
+	#define NH_NEIGHBORS	4
+#elif NEIGHBORHOOD == NH_DIAGONAL
+	#define NH_OFFSETS		_NH_OFFSETS_DIAGONAL
+	#define NH_NAME			"DIAGONAL"
+	#define NH_NEIGHBORS	4
+#elif NEIGHBORHOOD == NH_HEX
+	#define NH_OFFSETS		_NH_OFFSETS_HEX
+	#define NH_NAME			"HEX"
+	#define NH_NEIGHBORS	6
+#elif NEIGHBORHOOD == NH_KNIGHT
+	#define NH_OFFSETS		_NH_OFFSETS_KNIGHT
+	#define NH_NAME			"KNIGHT"
+	#define NH_NEIGHBORS	8
+#elif NEIGHBORHOOD == NH_MOORE2
+	#define NH_OFFSETS		_NH_OFFSETS_MOORE2
+	#define NH_NAME			"MOORE2"
+	#define NH_NEIGHBORS	24
+#elif NEIGHBORHOOD == NH_VON_NEUMANN2
+	#define NH_OFFSETS		_NH_OFFSETS_VON_NEUMANN2
+	#define NH_NAME			"VON_NEUMANN2"
+	#define NH_NEIGHBORS	12
+#else
+	#error "invalid neighborhood. must be NH_MOORE, NH_VON_NEUMANN, NH_DIAGONAL, NH_HEX, NH_KNIGHT, NH_MOORE2, or NH_VON_NEUMANN2"
+#endif
+
+#define _NH_ONE(x, y, ...) + 1
+_Static_assert((0 NH_OFFSETS(_NH_ONE, 0)) == NH_NEIGHBORS, "NH_NEIGHBORS doesn't match NH_OFFSETS");
+
+// the largest neighbor count, including the center.
+#define NH_COUNT (NH_NEIGHBORS + NH_CENTER)
+
+#if NH_CENTER
+	#define NH_CENTER_NAME "+center"
+#else
+	#define NH_CENTER_NAME ""
+#endif
+
+// the 3x3 neighborhoods without the center use the 3-bit counters, NEXT_COND, and the
+// other fast paths below. everything else is "wide", and uses the generic counter with
+// NH_BITS bits, which is always enough that the count never wraps around.
+#define NH_WIDE (NEIGHBORHOOD > NH_DIAGONAL || NH_CENTER)
+
+#if !NH_WIDE || NH_COUNT < 8
+	#define NH_BITS 3
+#elif NH_COUNT < 16
+	#define NH_BITS 4
+#else
+	#define NH_BITS 5
+#endif
+
+#if NH_WIDE
+	// there is no NEXT_COND for these, so the ruleset is always parsed from RULESET. past 9
+	// neighbors, the counts are separated by commas (see Ruleset_parse).
+	#ifndef RULESET
+		#pragma message("RULESET not given. assuming B3/S23.")
+		#if NH_COUNT > 9
+			#define RULESET "B3/S2,3"
+		#else
+			#define RULESET "B3/S23"
+		#endif
+	#endif
+#elif !defined(NEXT_COND)
+	// NOTE: 0 and 8 are always the same, so not all conditions are allowed.
+
+	#pragma message("NEXT_COND not given. assuming B3/S23.")
+	#define NEXT_COND ~n2 & n1 & (n0 | s)
+#endif
+
+#if defined(LUT_RULE) && !defined(RULESET)
+	#define RULESET LUT_RULE
+#endif
+
 #ifndef RULESET
 	#pragma message("RULESET not given. defaulting to unknown")
 	#define RULESET "unknown"
 #endif
 
-#if NEIGHBORHOOD != NH_MOORE && NEIGHBORHOOD != NH_VON_NEUMANN && NEIGHBORHOOD != NH_DIAGONAL
-	#error "invalid neighborhood. must be NH_MOORE, NH_VON_NEUMANN, or NH_DIAGONAL"
+#define KERNEL_BITWISE	0 // NEXT_COND on the neighbor counter bits (this file)
+#define KERNEL_LUT		1 // 24-bit row lookup table (matx8-lut.h)
+
+#ifndef KERNEL
+	#define KERNEL KERNEL_BITWISE
+#endif
+
+#if KERNEL != KERNEL_BITWISE && KERNEL != KERNEL_LUT
+	#error "invalid kernel. must be KERNEL_BITWISE or KERNEL_LUT"
+#endif
+
+#if defined(LUT_RULE) && KERNEL != KERNEL_LUT
+	#error "LUT_RULE requires KERNEL=KERNEL_LUT"
+#endif
+
+#if NH_WIDE && KERNEL == KERNEL_LUT
+	#error "KERNEL_LUT only supports the 3x3 neighborhoods without the center"
 #endif
 
 // NOTE: adds a 1-bit value `x` to a 3-bit accumulator. 8 wraps around to 0.
@@ -41,51 +161,271 @@
 	(void) 0;      \
 })
 
-static Matx8 Matx8_next(const Matx8 this) {
-	register u64 // neighbor counter bits
-		n2 = 0,  // counter output bit 2. e.g. (n >> 2) & 1
-		n1 = 0,  // counter output bit 1. e.g. (n >> 1) & 1
-		n0 = 0,  // counter output bit 0. e.g. (n >> 0) & 1
-		c0;      // carry bit for counter bit 0
-
-	const u64
-		cl = Matx8_xroll(this.matx, 7), // center left
-		cr = Matx8_xroll(this.matx, 1); // center right
-
-	// the code with the _3BIT_ADD stuff is basically just this:
-	// neighbors = (ul + uc + ur) + (cl + cr) + (dl + dc + dr)
-	// but avoiding the issue that is it is trying to fit potentially 4 bits of information
-	// into each bit, which will overflow all over the place and return garbage,
-	// so instead the adders have each bit separated out so there are no overflows.
-
-#if NEIGHBORHOOD == NH_MOORE || NEIGHBORHOOD == NH_VON_NEUMANN
-	const u64
-		uc = Matx8_yroll(this.matx, 7), // up center
-		dc = Matx8_yroll(this.matx, 1); // down center
-
-	_3BIT_ADD(c0, n2, n1, n0, cl);
-	_3BIT_ADD(c0, n2, n1, n0, cr);
-
-	_3BIT_ADD(c0, n2, n1, n0, uc);
-	_3BIT_ADD(c0, n2, n1, n0, dc);
+// 3-input XOR and majority, which are the sum and carry of a full adder.
+// with AVX-512, each of these is one VPTERNLOG for the vector plane types. GCC doesn't
+// reliably merge the two-input operations into those by itself. VPTERNLOG only works
+// on vector registers, so plain u64 planes always use the normal operations.
+#if defined(__AVX512F__) && defined(__AVX512VL__)
+	typedef u64 _u64x2 __attribute__((vector_size(16)));
+	typedef u64 _u64x4 __attribute__((vector_size(32)));
+	typedef u64 _u64x8 __attribute__((vector_size(64)));
+	typedef long long _i64x2 __attribute__((vector_size(16)));
+	typedef long long _i64x4 __attribute__((vector_size(32)));
+	typedef long long _i64x8 __attribute__((vector_size(64)));
+	typedef u64 _u64x16 __attribute__((vector_size(128))); // 32x32 boards (board.h)
+
+	// the immediate has to be a literal at the builtin, so it can't be a parameter.
+	#define _TERNLOG_FNS(name, imm)                                                   \
+		static FORCE_INLINE _u64x2 name##_128(_u64x2 a, _u64x2 b, _u64x2 c) {         \
+			return (_u64x2) __builtin_ia32_pternlogq128_mask(                         \
+				(_i64x2) a, (_i64x2) b, (_i64x2) c, imm, (u8) -1);                    \
+		}                                                                             \
+		static FORCE_INLINE _u64x4 name##_256(_u64x4 a, _u64x4 b, _u64x4 c) {         \
+			return (_u64x4) __builtin_ia32_pternlogq256_mask(                         \
+				(_i64x4) a, (_i64x4) b, (_i64x4) c, imm, (u8) -1);                    \
+		}                                                                             \
+		static FORCE_INLINE _u64x8 name##_512(_u64x8 a, _u64x8 b, _u64x8 c) {         \
+			return (_u64x8) __builtin_ia32_pternlogq512_mask(                         \
+				(_i64x8) a, (_i64x8) b, (_i64x8) c, imm, (u8) -1);                    \
+		}                                                                             \
+		static FORCE_INLINE _u64x16 name##_1024(_u64x16 a, _u64x16 b, _u64x16 c) {    \
+			/* two registers, one for each half */                                    \
+			union { _u64x16 v; _u64x8 h[2]; } x = {a}, y = {b}, z = {c};              \
+			x.h[0] = name##_512(x.h[0], y.h[0], z.h[0]);                              \
+			x.h[1] = name##_512(x.h[1], y.h[1], z.h[1]);                              \
+			return x.v;                                                               \
+		}
+
+	_TERNLOG_FNS(_ternlog_xor3, 0x96)
+	_TERNLOG_FNS(_ternlog_maj, 0xE8)
+
+	static FORCE_INLINE u64 _xor3_u64(u64 a, u64 b, u64 c) { return a ^ b ^ c; }
+	static FORCE_INLINE u64 _maj_u64(u64 a, u64 b, u64 c) { return a & b | c & (a ^ b); }
+
+	#define _XOR3(a, b, c) _Generic((a), _u64x2: _ternlog_xor3_128, _u64x4: _ternlog_xor3_256, \
+		_u64x8: _ternlog_xor3_512, _u64x16: _ternlog_xor3_1024, default: _xor3_u64)(a, b, c)
+	#define _MAJ(a, b, c) _Generic((a), _u64x2: _ternlog_maj_128, _u64x4: _ternlog_maj_256, \
+		_u64x8: _ternlog_maj_512, _u64x16: _ternlog_maj_1024, default: _maj_u64)(a, b, c)
+#else
+	#define _XOR3(a, b, c) ((a) ^ (b) ^ (c))
+	#define _MAJ(a, b, c)  ((a) & (b) | (c) & ((a) ^ (b)))
 #endif
 
-#if NEIGHBORHOOD == NH_MOORE || NEIGHBORHOOD == NH_DIAGONAL
-	const u64
-		ul = Matx8_yroll(cl, 7), // up left
-		ur = Matx8_yroll(cr, 7), // up right
-		dl = Matx8_yroll(cl, 1), // down left
-		dr = Matx8_yroll(cr, 1); // down right
+// the neighbor counters. each one sets the 3-bit count n2:n1:n0 from the neighbor
+// planes that `nh` uses. 8 wraps around to 0 in both of them (see _3BIT_ADD).
+
+// adds the neighbors one at a time. every add depends on the previous one.
+#define _MATX8_COUNT_SERIAL(T, nh, n2, n1, n0, ul, uc, ur, cl, cr, dl, dc, dr) ({  \
+	T c0; /* carry bit for counter bit 0 */                                       \
+	n2 = n1 = n0 = (T) {0};                                                       \
+	                                                                              \
+	/* these conditions are constant, so only one side is ever compiled. */       \
+	if ((nh) == NH_MOORE || (nh) == NH_VON_NEUMANN) {                             \
+		_3BIT_ADD(c0, n2, n1, n0, cl);                                            \
+		_3BIT_ADD(c0, n2, n1, n0, cr);                                            \
+		_3BIT_ADD(c0, n2, n1, n0, uc);                                            \
+		_3BIT_ADD(c0, n2, n1, n0, dc);                                            \
+	}                                                                             \
+	                                                                              \
+	if ((nh) == NH_MOORE || (nh) == NH_DIAGONAL) {                                \
+		_3BIT_ADD(c0, n2, n1, n0, ul);                                            \
+		_3BIT_ADD(c0, n2, n1, n0, ur);                                            \
+		_3BIT_ADD(c0, n2, n1, n0, dl);                                            \
+		_3BIT_ADD(c0, n2, n1, n0, dr);                                            \
+	}                                                                             \
+	(void) 0;                                                                     \
+})
 
-	_3BIT_ADD(c0, n2, n1, n0, ul);
-	_3BIT_ADD(c0, n2, n1, n0, ur);
+// carry-save adder tree. the neighbors are reduced with full and half adders, so
+// most of the operations are independent of each other, and there are fewer of them.
+// 8 neighbors: 25 operations, or 13 with VPTERNLOG. 4 neighbors: 9, or 8.
+#define _MATX8_COUNT_CSA(T, nh, n2, n1, n0, ul, uc, ur, cl, cr, dl, dc, dr) ({     \
+	if ((nh) == NH_MOORE) {                                                       \
+		/* weight 1: three adders for the three rows */                           \
+		const T                                                                   \
+			s1 = _XOR3(ul, uc, ur), c1 = _MAJ(ul, uc, ur),                        \
+			s2 = _XOR3(dl, dc, dr), c2 = _MAJ(dl, dc, dr),                        \
+			s3 = (cl) ^ (cr),       c3 = (cl) & (cr);                             \
+		                                                                          \
+		n0 = _XOR3(s1, s2, s3);                                                   \
+		                                                                          \
+		/* weight 2: c1 + c2 + c3 + c4 is at most 4 */                            \
+		const T                                                                   \
+			c4 = _MAJ(s1, s2, s3),                                                \
+			t  = _XOR3(c1, c2, c3),                                               \
+			c5 = _MAJ(c1, c2, c3);                                                \
+		                                                                          \
+		n1 = t ^ c4;                                                              \
+		n2 = c5 ^ t & c4; /* both are set for 8 neighbors, which wraps to 0 */    \
+	}                                                                             \
+	else {                                                                        \
+		/* a + b + c + d. for two half adders, the sum and carry aren't both set, */ \
+		/* so c1 + c2 + c3 is at most 2, and c3 is never set with c1 or c2. */    \
+		const T                                                                   \
+			a = (nh) == NH_VON_NEUMANN ? (uc) : (ul),                             \
+			b = (nh) == NH_VON_NEUMANN ? (cl) : (ur),                             \
+			c = (nh) == NH_VON_NEUMANN ? (cr) : (dl),                             \
+			d = (nh) == NH_VON_NEUMANN ? (dc) : (dr),                             \
+			s1 = a ^ b, c1 = a & b,                                               \
+			s2 = c ^ d, c2 = c & d;                                               \
+		                                                                          \
+		n0 = s1 ^ s2;                                                             \
+		n1 = _XOR3(c1, c2, s1 & s2);                                              \
+		n2 = c1 & c2;                                                             \
+	}                                                                             \
+	(void) 0;                                                                     \
+})
 
-	_3BIT_ADD(c0, n2, n1, n0, dl);
-	_3BIT_ADD(c0, n2, n1, n0, dr);
+#ifndef COUNTER
+	#define COUNTER _MATX8_COUNT_CSA
 #endif
 
-	const u64 s = this.matx;
-	(void) s; // some rulesets don't directly depend on the current state
+// the rule is a macro so the same code can step a single board (u64), a vector of
+// independent boards (u64xN in matx8-simd.h), or one cell of 64 bit-sliced boards
+// (matx8-bitslice.h). `cond` is an expression like NEXT_COND, `T` is the plane type,
+// `nh` is the neighborhood, `count` is one of the counters above, and the other
+// arguments are the planes for the center cell and each of its neighbors. it evaluates
+// to the next plane. only the neighbors that the neighborhood uses are evaluated.
+#define _MATX8_RULE_EVAL(cond, count, T, nh, center, ul, uc, ur, cl, cr, dl, dc, dr) ({ \
+	const T s = (center); /* some rulesets don't directly depend on the current state */ \
+	(void) s;                                                                         \
+	                                                                                  \
+	register T /* neighbor counter bits */                                            \
+		n2, /* counter output bit 2. e.g. (n >> 2) & 1 */                             \
+		n1, /* counter output bit 1. e.g. (n >> 1) & 1 */                             \
+		n0; /* counter output bit 0. e.g. (n >> 0) & 1 */                             \
+	                                                                                  \
+	if ((nh) == NH_MOORE) {                                                           \
+		const T                                                                       \
+			_ul = (ul), _uc = (uc), _ur = (ur),                                       \
+			_cl = (cl),             _cr = (cr),                                       \
+			_dl = (dl), _dc = (dc), _dr = (dr);                                       \
+		                                                                              \
+		count(T, NH_MOORE, n2, n1, n0, _ul, _uc, _ur, _cl, _cr, _dl, _dc, _dr);       \
+	}                                                                                 \
+	else if ((nh) == NH_VON_NEUMANN) {                                                \
+		const T _uc = (uc), _cl = (cl), _cr = (cr), _dc = (dc), _0 = {0};             \
+		count(T, NH_VON_NEUMANN, n2, n1, n0, _0, _uc, _0, _cl, _cr, _0, _dc, _0);     \
+	}                                                                                 \
+	else {                                                                            \
+		const T _ul = (ul), _ur = (ur), _dl = (dl), _dr = (dr), _0 = {0};             \
+		count(T, NH_DIAGONAL, n2, n1, n0, _ul, _0, _ur, _0, _0, _dl, _0, _dr);        \
+	}                                                                                 \
+	                                                                                  \
+	(void) n2; (void) n1; (void) n0; /* not every condition uses all of them */       \
+	(T) (cond);                                                                       \
+})
+
+#define _MATX8_RULE_WITH(count, T, nh, center, ul, uc, ur, cl, cr, dl, dc, dr) \
+	_MATX8_RULE_EVAL(NEXT_COND, count, T, nh, center, ul, uc, ur, cl, cr, dl, dc, dr)
+
+#define _MATX8_RULE(T, nh, center, ul, uc, ur, cl, cr, dl, dc, dr) \
+	_MATX8_RULE_WITH(COUNTER, T, nh, center, ul, uc, ur, cl, cr, dl, dc, dr)
+
+// steps a whole board with rolls. `xroll` and `yroll` are the roll functions for `T`.
+#define _MATX8_NEXT_EVAL(cond, count, T, nh, state, xroll, yroll) ({                  \
+	const T                                                                           \
+		_s  = (state),                                                                \
+		_xl = xroll(_s, 7), /* center left  */                                        \
+		_xr = xroll(_s, 1); /* center right */                                        \
+	                                                                                  \
+	_MATX8_RULE_EVAL(cond, count, T, nh, _s,                                          \
+		yroll(_xl, 7), yroll(_s, 7), yroll(_xr, 7),                                   \
+		_xl          ,               _xr          ,                                   \
+		yroll(_xl, 1), yroll(_s, 1), yroll(_xr, 1)                                    \
+	);                                                                                \
+})
+
+#define _MATX8_NEXT_WITH(count, T, nh, state, xroll, yroll) \
+	_MATX8_NEXT_EVAL(NEXT_COND, count, T, nh, state, xroll, yroll)
 
-	return (Matx8) {.matx = NEXT_COND};
+#define _MATX8_NEXT(T, nh, state, xroll, yroll) \
+	_MATX8_NEXT_WITH(COUNTER, T, nh, state, xroll, yroll)
+
+// the counters are basically just this:
+// neighbors = (ul + uc + ur) + (cl + cr) + (dl + dc + dr)
+// but avoiding the issue that is it is trying to fit potentially 4 bits of information
+// into each bit, which will overflow all over the place and return garbage,
+// so instead the adders have each bit separated out so there are no overflows.
+
+// the generic counter for the wide neighborhoods. `p` is an array of `len` planes of
+// weight 1 with room for `len` more, and `n` gets the NH_BITS-bit count. each weight is
+// reduced with full adders until one or two planes are left, and then a half adder gives
+// that bit of the count. every carry goes to the next weight. the number of adders is
+// computed before each inner loop instead of being a loop condition, because GCC only
+// fully unrolls it that way. then it is a branch-free adder tree like _MATX8_COUNT_CSA.
+#define _MATX8_COUNT_WIDE(T, n, p, len) ({                                           \
+	T _c[NH_COUNT]; /* carries */                                                    \
+	u8 _len = (len);                                                                 \
+	                                                                                 \
+	_Pragma("GCC unroll 8")                                                          \
+	for (u8 _b = 0; _b < NH_BITS; _b++) {                                            \
+		/* each full adder turns 3 planes into 1, and the sum goes on the end */     \
+		const u8 _fa = _len >= 3 ? (_len - 1) / 2 : 0, _i = 3*_fa;                   \
+		u8 _clen = _fa;                                                              \
+		                                                                             \
+		_Pragma("GCC unroll 16")                                                     \
+		for (u8 _k = 0; _k < _fa; _k++) {                                            \
+			(p)[_len + _k] = _XOR3((p)[3*_k], (p)[3*_k + 1], (p)[3*_k + 2]);         \
+			_c[_k]         = _MAJ((p)[3*_k], (p)[3*_k + 1], (p)[3*_k + 2]);          \
+		}                                                                            \
+		                                                                             \
+		_len += _fa;                                                                 \
+		                                                                             \
+		if (_len - _i == 2) {                                                        \
+			(n)[_b]     = (p)[_i] ^ (p)[_i + 1];                                     \
+			_c[_clen++] = (p)[_i] & (p)[_i + 1];                                     \
+		}                                                                            \
+		else                                                                         \
+			(n)[_b] = _len - _i == 1 ? (p)[_i] : (T) {0};                            \
+		                                                                             \
+		/* the carries are the planes for the next weight */                         \
+		_Pragma("GCC unroll 16")                                                     \
+		for (u8 _j = 0; _j < _clen; _j++)                                            \
+			(p)[_j] = _c[_j];                                                        \
+		                                                                             \
+		_len = _clen;                                                                \
+	}                                                                                \
+	(void) 0;                                                                        \
+})
+
+// the plane for the neighbor at (x, y), for NH_OFFSETS. cell i of it is cell i + (x, y).
+#define _NH_PLANE(x, y, p, len, state, xroll, yroll) \
+	(p)[(len)++] = yroll(xroll(state, (x) & 7), (y) & 7);
+
+// steps a whole board for a wide neighborhood. `cond` uses `n`, the array of counter
+// bits, and `s`, like _RULESET_COND_WIDE. the other arguments are the same as above.
+#define _MATX8_NEXT_WIDE(cond, T, state, xroll, yroll) ({                            \
+	const T s = (state);                                                             \
+	T _p[2*NH_COUNT], n[NH_BITS];                                                    \
+	u8 _np = 0;                                                                      \
+	                                                                                 \
+	NH_OFFSETS(_NH_PLANE, _p, _np, s, xroll, yroll)                                  \
+	                                                                                 \
+	if (NH_CENTER)                                                                   \
+		_p[_np++] = s;                                                               \
+	                                                                                 \
+	_MATX8_COUNT_WIDE(T, n, _p, _np);                                                \
+	(T) (cond);                                                                      \
+})
+
+#include "ruleset.h"
+
+#if KERNEL == KERNEL_LUT
+#include "matx8-lut.h"
+
+// NOTE: this needs `Matx8_lut_init_default` to be called first.
+static Matx8 Matx8_next(const Matx8 this) {
+	return Matx8__next_lut(this);
+}
+#elif NH_WIDE
+static Matx8 Matx8_next(const Matx8 this) {
+	return (Matx8) {.matx = RULESET_EVAL(u64, _MATX8_NEXT_WIDE, u64, this.matx,
+		Matx8__xroll_u, Matx8__yroll_u)};
 }
+#else
+static Matx8 Matx8_next(const Matx8 this) {
+	return (Matx8) {.matx = RULESET_EVAL(u64, _MATX8_NEXT_EVAL, COUNTER, u64, NEIGHBORHOOD,
+		this.matx, Matx8__xroll_u, Matx8__yroll_u)};
+}
+#endif
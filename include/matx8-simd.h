@@ -0,0 +1,69 @@
+#pragma once
+#define MATX8_SIMD_H
+
+// defines Matx8xN, a vector of independent boards that are stepped together.
+
+#include "matx8.h"
+#include "matx8-next.h"
+
+// one board per 64-bit lane. 8 lanes for AVX-512, 4 for AVX2, and 2 for plain SSE2.
+#ifndef SIMD_LANES
+	#if defined(__AVX512F__)
+		#define SIMD_LANES 8
+	#elif defined(__AVX2__)
+		#define SIMD_LANES 4
+	#else
+		#define SIMD_LANES 2
+	#endif
+#endif
+
+#if SIMD_LANES != 2 && SIMD_LANES != 4 && SIMD_LANES != 8
+	#error "SIMD_LANES must be 2, 4, or 8"
+#endif
+
+typedef u64 u64xN __attribute__((vector_size(SIMD_LANES * sizeof(u64))));
+
+typedef union {
+	u64xN matx;                 // every board as one vector
+	u64 lanes[SIMD_LANES];      // each board as a separate integer
+	Matx8 boards[SIMD_LANES];   // each board as a separate matrix
+} Matx8xN;
+
+// these are the same as the u64 versions in matx8.h, but for every lane at once.
+// GCC broadcasts the scalar operands, and the rotates turn into VPRORQ on AVX-512.
+
+static FORCE_INLINE u64xN Matx8xN__xroll_u(const u64xN state, u8 x) {
+	x &= 7;
+
+	if (x == 0)
+		return state;
+
+	const u64 mask = Matx8_xroll_masks[x];
+
+	return (state >> x) & mask | (state << (8 - x)) & ~mask;
+}
+
+static FORCE_INLINE u64xN Matx8xN__yroll_u(const u64xN state, u8 y) {
+	y = (y & 7) << 3;
+
+	if (y == 0)
+		return state;
+
+	return state >> y | state << (64 - y);
+}
+
+static FORCE_INLINE Matx8xN Matx8xN_next(Matx8xN this) {
+#if KERNEL == KERNEL_LUT
+	// the table lookups can't be vectorized, so just do one lane at a time.
+	for (u8 lane = 0; lane < SIMD_LANES; lane++)
+		this.boards[lane] = Matx8_next(this.boards[lane]);
+
+	return this;
+#elif NH_WIDE
+	return (Matx8xN) {.matx = RULESET_EVAL(u64xN, _MATX8_NEXT_WIDE, u64xN, this.matx,
+		Matx8xN__xroll_u, Matx8xN__yroll_u)};
+#else
+	return (Matx8xN) {.matx = RULESET_EVAL(u64xN, _MATX8_NEXT_EVAL, COUNTER, u64xN, NEIGHBORHOOD,
+		this.matx, Matx8xN__xroll_u, Matx8xN__yroll_u)};
+#endif
+}
@@ -27,11 +27,31 @@
 
 #define FORCE_INLINE inline __attribute__((gnu_inline, always_inline))
 
+// the sizes that can change at runtime. they start at the compiled defaults, and the ones
+// in CALIBFILE replace them at startup (calibrate.h).
+static struct {
+	// u32 instead of u8, so the stores to the tables can't alias them, and they stay in registers.
+	u32 table_bits;   // log2 of the home slots of the hash tables. at most TABLE_BITS_MAX
+	u32 rand_buf_len; // Matx8_random buffer length. a power of 2, at most 256
+	u32 width;        // trials the interleaved engine runs at once. 1 is `run_once`
+} tune = {
+	.table_bits   = TABLE_BITS,
+	.rand_buf_len = RAND_BUF_LEN,
+	.width        = INTERLEAVE_WIDTH,
+};
+
 typedef union {
 	u64 matx;   // the whole matrix as a single integer
 	u8 rows[8]; // each row as a separate integer
 } Matx8;
 
+// 64 boards in bit-sliced (transposed) form. bit b of cells[k] is bit k of board b,
+// so one bitwise operation on a cell does the same thing for all 64 boards.
+// aligned so that the cells can be loaded as vectors (see matx8-bitslice.h).
+typedef struct {
+	u64 cells[64] __attribute__((aligned(64)));
+} Matx8x64;
+
 // these are ordered from least to most work to compute (important).
 // NOTE: these can't be an enum because they have to be integer constant
 //       expressions at preproc time, which enum members are not.
@@ -89,7 +109,7 @@ constexpr u64 Matx8_xroll_masks[8] = {
 //////////////////////////////// methods ////////////////////////////////
 
 static FORCE_INLINE u32 Matx8__hash_u(u64 state) {
-	return state * 0xff51afd7ed558ccdllu >> 64 - TABLE_BITS;
+	return state * 0xff51afd7ed558ccdllu >> 64 - tune.table_bits;
 }
 
 static FORCE_INLINE u64 Matx8__xroll_u(const u64 state, u8 x) {
@@ -162,6 +182,20 @@ static FORCE_INLINE u64 Matx8__adtrs_u(u64 state) {
 	return state;
 }
 
+static void Matx8__mdtrs64(u64 m[64]) {
+	// main diagonal transpose of a 64x64 bit matrix, where m[i] is row i.
+	// same idea as Matx8__mdtrs_u, but the blocks are swapped between words.
+	u64 mask = 0x00000000FFFFFFFFllu;
+
+	for (u8 j = 32; j != 0; j >>= 1, mask ^= mask << j) {
+		for (u8 k = 0; k < 64; k = (k + j + 1) & ~j) {
+			const u64 tmp = (m[k] >> j ^ m[k + j]) & mask;
+			m[k]     ^= tmp << j;
+			m[k + j] ^= tmp;
+		}
+	}
+}
+
 static FORCE_INLINE u64 Matx8__rot90_u(u64 state) {
 	return Matx8__yflip_u(Matx8__mdtrs_u(state));
 }
@@ -222,6 +256,19 @@ static FORCE_INLINE Matx8 Matx8__mdtrs(Matx8 this) {
 	return (Matx8) {.matx = Matx8__mdtrs_u(this.matx)};
 }
 
+static void Matx8_slice(Matx8x64 *const restrict out, const Matx8 *const restrict boards) {
+	// transpose 64 boards into bit-sliced form.
+	memcpy(out->cells, boards, sizeof out->cells);
+	Matx8__mdtrs64(out->cells);
+}
+
+static void Matx8_unslice(Matx8 *const restrict boards, const Matx8x64 *const restrict in) {
+	// transpose 64 bit-sliced boards back into separate boards.
+	Matx8x64 tmp = *in;
+	Matx8__mdtrs64(tmp.cells);
+	memcpy(boards, tmp.cells, sizeof tmp.cells);
+}
+
 static FORCE_INLINE Matx8 Matx8__adtrs(Matx8 this) {
 	return (Matx8) {.matx = Matx8__adtrs_u(this.matx)};
 }
@@ -262,6 +309,41 @@ static FORCE_INLINE Matx8 Matx8__tfm(Matx8 this, const u8 tfm) {
 	#error "RAND_BUF_LEN must be at least 1"
 #elif RAND_BUF_LEN > 256
 	#error "RAND_BUF_LEN must be 256 or less"
+#elif COUNTER_RAND
+// draw `i` is splitmix64 of the key plus `i` times the golden ratio, so every draw can be
+// made again on its own, without the ones before it. runs with the same seed get the same
+// start states, and a run that starts at a later draw (`-g SEED:FIRST`) doesn't overlap with
+// the earlier ones until it gets that far. it is three multiplies and no DLL call, so there
+// is no buffer, and it is faster than buffered RtlGenRandom.
+static struct {
+	u64 key;     // splitmix64 of the seed
+	u64 counter; // index of the next draw
+	u64 seed;    // the seed, from `-g` or RtlGenRandom
+	u64 first;   // the trial `-g` started at
+	bool seeded; // whether `-g` was given
+} rng = {0};
+
+static FORCE_INLINE u64 _rand_mix(u64 z) {
+	// the splitmix64 finalizer. it is a bijection, so different counters never collide.
+	z = (z ^ z >> 30) * 0xbf58476d1ce4e5b9llu;
+	z = (z ^ z >> 27) * 0x94d049bb133111ebllu;
+	return z ^ z >> 31;
+}
+
+static FORCE_INLINE u64 Rand_at(const u64 i) {
+	// draw number `i` of the current seed.
+	return _rand_mix(rng.key + (i + 1) * 0x9e3779b97f4a7c15llu);
+}
+
+static FORCE_INLINE void Rand_seed(const u64 seed, const u64 counter) {
+	// mixing the seed first means nearby seeds don't give shifted copies of each other.
+	rng.key     = _rand_mix(seed);
+	rng.counter = counter;
+}
+
+static FORCE_INLINE Matx8 Matx8_random(void) {
+	return (Matx8) {.matx = Rand_at(rng.counter++)};
+}
 #elif RAND_BUF_LEN == 1
 static FORCE_INLINE Matx8 Matx8_random(void) {
 	// RDRAND is only faster than RtlGenRandom in the unbuffered case
@@ -291,19 +373,16 @@ static FORCE_INLINE Matx8 Matx8_random(void) {
 	// 512 (u32 idx): 6.23%
 
 static Matx8 Matx8_random(void) {
+	// the buffer always has room for 256, and `tune.rand_buf_len` is how much of it is used.
+	// if it changes, whatever is left from the old length is still random, so it is fine.
 	_Static_assert((RAND_BUF_LEN & (RAND_BUF_LEN - 1)) == 0, "RAND_BUF_LEN must be power of two");
 
-	static u64 buffer[RAND_BUF_LEN] __attribute__((aligned(64)));
+	static u64 buffer[256] __attribute__((aligned(64)));
 	static u8 idx = 0; // initialize the first time it is called.
 
-#if RAND_BUF_LEN < 256
-	if (idx >= RAND_BUF_LEN)
-		__builtin_unreachable();
-#endif
-
 	unlikelyp_if (idx == 0, 1.0 - 1.0 / RAND_BUF_LEN) {
-		RtlGenRandom(buffer, sizeof buffer);
-		idx = RAND_BUF_LEN & UINT8_MAX; // NOTE: still fine for 256
+		RtlGenRandom(buffer, tune.rand_buf_len * sizeof(u64));
+		idx = tune.rand_buf_len & UINT8_MAX; // NOTE: still fine for 256
 	}
 
 	return (Matx8) {
@@ -0,0 +1,147 @@
+#pragma once
+#define MEMO_H
+
+// defines the trajectory memo and the Memo_* API, for `run_once`. requires symmetry.h.
+
+// Matx8_next commutes with the rolls and with the transforms that map the neighborhood to
+// itself, so every state of a finished trial is solved for its whole orbit: the number of
+// steps left to the first state of the cycle, the period, and that first state, up to the
+// same symmetry. every MEMO_STRIDE steps, `run_once` looks the current state up, and if
+// its orbit is in the memo, the trial is done right there. the states it checked on the
+// way are added once it finishes, so the memo fills in backwards along the trajectories.
+
+// the key is the orbit fingerprint (symmetry.h). a matching fingerprint is only a hit if the
+// state is in the orbit of the stored one, and the symmetry between them also maps the
+// stored end state to this one's.
+
+// the memo has 2^MEMO_BITS entries, in sets of MEMO_WAYS. a full set replaces an entry with
+// CLOCK (second chance): every hit sets a bit, and the hand clears them until it finds one
+// that hasn't been used since it last went by.
+
+#define MEMO_WAYS	4
+#define MEMO_SETS	((1 << MEMO_BITS) / MEMO_WAYS)
+
+// the most states a trial checks. the rare trial that is longer than CYCLE_STEP_MAX only
+// has its first ones added.
+#define MEMO_POINTS	(CYCLE_STEP_MAX / MEMO_STRIDE + 1)
+
+_Static_assert(PERIOD_LEN <= UINT16_MAX + 1, "the periods are 16-bit");
+
+typedef struct {
+	u64 fp;      // fingerprint of the orbit. 0 is an empty entry
+	Matx8 state; // a state in the orbit
+	Matx8 end;   // the first state on the cycle, for the trajectory of `state`
+	u16 left;    // steps from `state` to `end`. always at least 1
+	u16 period;
+	bool used;   // CLOCK bit
+} MemoEntry;
+
+typedef struct {
+	u64 fp;
+	Matx8 state;
+	u32 step;
+} MemoPoint;
+
+static struct {
+	MemoEntry entries[MEMO_SETS][MEMO_WAYS];
+	u8 hands[MEMO_SETS];       // CLOCK hand of each set
+
+	MemoPoint points[MEMO_POINTS]; // the states the current trial has checked
+	u32 npoints;
+
+	u64 lookups;               // states that were looked up
+	u64 hits;                  // lookups that found the orbit
+	u64 false_hits;            // lookups with a matching fingerprint but a different orbit
+	u64 len;                   // entries that are in use
+} memo = {0};
+
+static void Memo_reset(void) {
+	// empties the memo and zeroes the counters.
+	memset(memo.entries, 0, sizeof memo.entries);
+	memset(memo.hands, 0, sizeof memo.hands);
+	memo.lookups = memo.hits = memo.false_hits = memo.len = 0;
+}
+
+static FORCE_INLINE u32 _memo_set(const u64 fp) {
+	return fp >> 32 & (MEMO_SETS - 1);
+}
+
+static bool Memo_get(const u64 fp, const Matx8 state, Matx8 *const restrict end, u32 *const restrict left, u32 *const restrict period) {
+	// looks up the orbit of `state`. if it is there, sets `end` to the first state on the
+	// cycle, `left` to the number of steps to it, and `period` to the period.
+	MemoEntry *const set = memo.entries[_memo_set(fp)];
+
+	memo.lookups++;
+
+	for (u8 i = 0; i < MEMO_WAYS; i++) {
+		MemoEntry *const e = set + i;
+
+		likely_if (e->fp != fp)
+			continue;
+
+		Symmetry g;
+
+		unlikely_if (!Symmetry_find(e->state, state, &g)) {
+			memo.false_hits++;
+			continue;
+		}
+
+		e->used = true;
+		*end    = Symmetry_apply(e->end, g);
+		*left   = e->left;
+		*period = e->period;
+		memo.hits++;
+		return true;
+	}
+
+	return false;
+}
+
+static void _memo_add(const MemoPoint *const restrict point, const Matx8 end, const u32 left, const u32 period) {
+	MemoEntry *const set = memo.entries[_memo_set(point->fp)];
+	u8 *const hand = memo.hands + _memo_set(point->fp);
+
+	// second chance for the ones that have been used since the hand last went by.
+	while (set[*hand].used) {
+		set[*hand].used = false;
+		*hand = (*hand + 1) % MEMO_WAYS;
+	}
+
+	MemoEntry *const e = set + *hand;
+	*hand = (*hand + 1) % MEMO_WAYS;
+
+	memo.len += e->fp == 0;
+
+	*e = (MemoEntry) {
+		.fp     = point->fp,
+		.state  = point->state,
+		.end    = end,
+		.left   = left,
+		.period = period,
+	};
+}
+
+static FORCE_INLINE void Memo_clear_points(void) {
+	memo.npoints = 0;
+}
+
+static FORCE_INLINE void Memo_point(const u64 fp, const Matx8 state, const u32 step) {
+	// remembers a state the current trial checked and didn't find, to add it at the end.
+	likelyp_if (memo.npoints < MEMO_POINTS, 0.9999999)
+		memo.points[memo.npoints++] = (MemoPoint) {.fp = fp, .state = state, .step = step};
+}
+
+static void Memo_finish(const Matx8 end, const u32 transient, const u32 period) {
+	// adds the states the trial checked, now that the first state on its cycle is known.
+	// the ones on the cycle are left out, since a trial that finds one of them could
+	// already have been on the cycle before it.
+	unlikelyp_if (period > UINT16_MAX, 0.9999999)
+		return; // only the spill table can find periods this long.
+
+	for (u32 i = 0; i < memo.npoints; i++) {
+		const MemoPoint *const point = memo.points + i;
+
+		likely_if (point->step < transient && transient - point->step <= UINT16_MAX)
+			_memo_add(point, end, transient - point->step, period);
+	}
+}
@@ -0,0 +1,289 @@
+#pragma once
+#define RULESET_H
+
+// the ruleset that the bitwise kernels use at runtime. by default it is the compiled
+// NEXT_COND, but `-r B36/S23` can change it to any outer-totalistic rule without
+// rebuilding. rules with a fast path get their own condition, and everything else is
+// evaluated from the truth table (see _RULESET_COND_ANF). `bnch rule` measures both.
+
+// the truth table is 16 bits, where bit s << 3 | n is the next state of a cell with
+// state s and n neighbors (mod 8). this is the same order that gen-ruleset uses.
+// for the wide neighborhoods, it is bit s << NH_BITS | n instead, which is 32 or 64 bits
+// when the counts don't fit in 3 bits. those always use the ANF (see _RULESET_COND_WIDE).
+
+#include "matx8.h"
+#include "matx8-next.h" // NH_*, NEXT_COND
+
+#if NH_BITS == 3
+	typedef u16 RulesetTT;
+#elif NH_BITS == 4
+	typedef u32 RulesetTT;
+#else
+	typedef u64 RulesetTT;
+#endif
+
+#define RULESET_TT_LEN (2 << NH_BITS) // truth table bits
+
+#define RULESET_COMPILED	0 // NEXT_COND
+#define RULESET_LIFE		1 // B3/S23
+#define RULESET_HIGHLIFE	2 // B36/S23
+#define RULESET_SEEDS		3 // B2/S
+#define RULESET_REPLICATOR	4 // B1357/S1357
+#define RULESET_LWOD		5 // B3/S012345678 (life without death)
+#define RULESET_ANF			6 // anything else
+
+// conditions for the fast paths, in the same form as NEXT_COND.
+#define _RULESET_COND_LIFE			~n2 & n1 & (n0 | s)
+#define _RULESET_COND_HIGHLIFE		n1 & (n2 ^ (n0 | s))
+#define _RULESET_COND_SEEDS			n1 & ~(n0 | n2 | s)
+#define _RULESET_COND_REPLICATOR	n0
+#define _RULESET_COND_LWOD			s | n0 & n1 & ~n2
+
+// the algebraic normal form of the truth table. `c` is 8 masks, one for each product
+// of n2, n1, and n0, that are either 0 or all ones. it is written so each XOR has an
+// AND under it, which is one VPTERNLOG each for the vector types.
+#define _RULESET_ANF3(c, n2, n1, n0) (                     \
+	(c)[0] ^ (n0) & (c)[1] ^ (n1) & ((c)[2] ^ (n0) & (c)[3]) ^ \
+	(n2) & ((c)[4] ^ (n0) & (c)[5] ^ (n1) & ((c)[6] ^ (n0) & (c)[7])) \
+)
+
+// f(s, n) = B(n) ^ s & (B(n) ^ S(n)). 30 operations, or about half that with VPTERNLOG.
+// `c` is 16 coefficient masks. they can be vectors with a different rule in each lane.
+#define _RULESET_COND_ANF_WITH(c) \
+	_RULESET_ANF3(c, n2, n1, n0) ^ s & _RULESET_ANF3((c) + 8, n2, n1, n0)
+
+#define _RULESET_COND_ANF _RULESET_COND_ANF_WITH(ruleset.anf)
+
+// the same thing for the wide kernel, where the count is the array `n` of NH_BITS planes.
+// each round pairs up the coefficients that only differ in the lowest variable that is
+// left, so there are RULESET_TT_LEN ANDs and XORs in total. `s` is the last variable.
+#define _RULESET_COND_WIDE_WITH(c) ({                                           \
+	typeof(n[0]) _v[RULESET_TT_LEN / 2];                                        \
+	                                                                            \
+	_Pragma("GCC unroll 32")                                                    \
+	for (u8 _x = 0; _x < RULESET_TT_LEN / 2; _x++)                              \
+		_v[_x] = (c)[2*_x] ^ n[0] & (c)[2*_x + 1];                              \
+	                                                                            \
+	_Pragma("GCC unroll 8")                                                     \
+	for (u8 _b = 1; _b < NH_BITS; _b++)                                         \
+		_Pragma("GCC unroll 16")                                                \
+		for (u8 _x = 0; _x < RULESET_TT_LEN >> (_b + 1); _x++)                  \
+			_v[_x] = _v[2*_x] ^ n[_b] & _v[2*_x + 1];                           \
+	                                                                            \
+	_v[0] ^ s & _v[1];                                                          \
+})
+
+#define _RULESET_COND_WIDE _RULESET_COND_WIDE_WITH(ruleset.anf)
+
+// counts 0 to 8 are the same bit for the 3-bit counters, so they have to match.
+#define _RULESET_WRAPS (NH_COUNT >= 1 << NH_BITS)
+
+// the truth table bits for one value of `s`, and the ones that can happen for the
+// neighborhood. 4 neighbors never has 5 to 7, for example.
+#define _RULESET_HALF ((RulesetTT) (((u64) 1 << (RULESET_TT_LEN / 2)) - 1))
+#define _RULESET_CARE_HALF (_RULESET_WRAPS ? _RULESET_HALF : \
+	(RulesetTT) (((u64) 1 << (NH_COUNT + 1)) - 1))
+#define _RULESET_CARE ((RulesetTT) (_RULESET_CARE_HALF | _RULESET_CARE_HALF << RULESET_TT_LEN / 2))
+
+// the most bytes that Ruleset_sprint can write. the wide ones use commas past 9.
+#define RULESET_STR_LEN (NH_COUNT > 9 ? 144 : 24)
+
+static struct {
+	u64 anf[RULESET_TT_LEN]; // ANF coefficient masks. the top bit of the index is s, and the rest is n.
+	const char *str;         // the ruleset string. NULL until Ruleset_set is called.
+	char name[RULESET_STR_LEN]; // `str` for rulesets that are only given as a truth table
+	RulesetTT tt;            // truth table
+	u32 b_tt, s_tt;          // birth and survival tables with bit n for n neighbors, for bw-search.h
+	u8 kind;                 // RULESET_*
+	bool given;              // it was given at runtime with `-r`
+} ruleset = {0};
+
+#if !NH_WIDE
+// the truth table of a condition, by evaluating it on every input at once.
+// only the care bits are kept, since those are the only ones that change the result.
+#define _RULESET_TT_OF(cond) ({                                     \
+	const u64 n0 = 0xAAAA, n1 = 0xCCCC, n2 = 0xF0F0, s = 0xFF00;    \
+	(void) n0; (void) n1; (void) n2; (void) s;                      \
+	(u16) (cond) & _RULESET_CARE;                                   \
+})
+#endif
+
+static const char *Ruleset_parse(RulesetTT *const restrict out, const char *restrict str) {
+	// parses `B.../S...` in either order and either case. returns an error message, or NULL.
+	// 8 neighbors is the same as 0 for the 3-bit counters, so they have to be given together.
+	// if the neighborhood can have more than 9 neighbors, the counts are separated by commas.
+	u32 given[2] = {0, 0}; // bit n is set if n is in B (index 0) or S (index 1)
+	bool seen[2] = {false, false};
+
+	for (u8 half = 0; half < 2; half++) {
+		const char c = *str++ | 32; // lowercase
+		const u8 part = c == 's';
+
+		unlikely_if (!part && c != 'b')
+			return "expected `B` or `S`";
+
+		unlikely_if (seen[part])
+			return "`B` or `S` given twice";
+
+		seen[part] = true;
+
+		while (*str >= '0' && *str <= '9') {
+			u32 n = *str++ - '0';
+
+			if (NH_COUNT > 9) {
+				while (*str >= '0' && *str <= '9' && n <= NH_COUNT)
+					n = 10*n + *str++ - '0';
+
+				if (*str == ',' && str[1] >= '0' && str[1] <= '9')
+					str++;
+			}
+
+			unlikely_if (n > NH_COUNT)
+				return "neighbor count is too large for the neighborhood";
+
+			given[part] |= 1u << n;
+		}
+
+		unlikely_if (half == 0 && *str++ != '/')
+			return "expected `/` between `B` and `S`";
+	}
+
+	unlikely_if (*str != '\0')
+		return "unexpected characters after the ruleset";
+
+	*out = 0;
+
+	for (u8 part = 0; part < 2; part++) {
+		unlikely_if (_RULESET_WRAPS && (given[part] & 1) != (given[part] >> 8 & 1))
+			return "0 and 8 neighbors have to be given together";
+
+		*out |= (RulesetTT) (given[part] & _RULESET_HALF) << (part * RULESET_TT_LEN / 2);
+	}
+
+	return NULL;
+}
+
+static RulesetTT Ruleset_compiled_tt(void) {
+#if NH_WIDE
+	RulesetTT tt;
+	const char *const error = Ruleset_parse(&tt, RULESET);
+
+	unlikely_if (error != NULL) {
+		eprintf("compiled RULESET \"%s\" is invalid for the neighborhood: %s\n", RULESET, error);
+		exit(EXIT_FAILURE);
+	}
+
+	return tt;
+#else
+	return _RULESET_TT_OF(NEXT_COND);
+#endif
+}
+
+static char *Ruleset_sprint(char *restrict buf, const RulesetTT tt) {
+	// writes the truth table as `B.../S...`. returns a pointer to the null terminator.
+	// needs at most RULESET_STR_LEN bytes. 8 is printed with 0 when they are the same bit.
+	for (u8 part = 0; part < 2; part++) {
+		*buf++ = "BS"[part];
+
+		for (u8 n = 0, first = true; n <= NH_COUNT; n++) {
+			if ((tt >> (part * RULESET_TT_LEN / 2 + n % (RULESET_TT_LEN / 2)) & 1) == 0)
+				continue;
+
+			if (NH_COUNT > 9 && !first)
+				*buf++ = ',';
+
+			if (n >= 10)
+				*buf++ = '0' + n / 10;
+
+			*buf++ = '0' + n % 10;
+			first  = false;
+		}
+
+		*buf++ = "/"[part]; // the null terminator for S
+	}
+
+	return buf - 1;
+}
+
+static RulesetTT Ruleset_dual(const RulesetTT tt) {
+	// the color dual. the complement of a board steps to the complement of the next board
+	// under this ruleset: f'(s, n) = ~f(~s, N - n). 0 and 8 swap, so they stay together.
+	constexpr u8 half = RULESET_TT_LEN / 2;
+	RulesetTT dual = 0;
+
+	for (u8 s = 0; s < 2; s++)
+		for (u8 n = 0; n <= NH_COUNT; n++)
+			dual |= (RulesetTT) (~tt >> ((s ^ 1) * half + (NH_COUNT - n) % half) & 1) << (s * half + n % half);
+
+	return dual & _RULESET_CARE;
+}
+
+static RulesetTT Ruleset_anf(RulesetTT tt) {
+	// Möbius transform from the truth table to the ANF coefficients
+	for (u8 i = 0; i <= NH_BITS; i++)
+		for (u8 x = 0; x < RULESET_TT_LEN; x++)
+			if (x >> i & 1)
+				tt ^= (RulesetTT) (tt >> (x ^ 1 << i) & 1) << x;
+
+	return tt;
+}
+
+static void Ruleset_set(const char *const restrict str, RulesetTT tt) {
+	// NOTE: `str` has to stay valid for the rest of the program.
+	//       if it is NULL, then the string is generated from the truth table.
+	tt &= _RULESET_CARE;
+
+	if (str != NULL)
+		ruleset.str = str;
+	else {
+		Ruleset_sprint(ruleset.name, tt);
+		ruleset.str = ruleset.name;
+	}
+
+	ruleset.tt   = tt;
+	ruleset.b_tt = tt & _RULESET_HALF;
+	ruleset.s_tt = tt >> RULESET_TT_LEN / 2;
+
+	if (_RULESET_WRAPS) {
+		ruleset.b_tt |= (ruleset.b_tt & 1) << 8;
+		ruleset.s_tt |= (ruleset.s_tt & 1) << 8;
+	}
+
+	const RulesetTT anf = Ruleset_anf(tt);
+
+	for (u8 x = 0; x < RULESET_TT_LEN; x++)
+		ruleset.anf[x] = -(u64) (anf >> x & 1);
+
+#if RUNTIME_RULESET && !NH_WIDE
+	if      (tt == Ruleset_compiled_tt())                    ruleset.kind = RULESET_COMPILED;
+	else if (tt == _RULESET_TT_OF(_RULESET_COND_LIFE))       ruleset.kind = RULESET_LIFE;
+	else if (tt == _RULESET_TT_OF(_RULESET_COND_HIGHLIFE))   ruleset.kind = RULESET_HIGHLIFE;
+	else if (tt == _RULESET_TT_OF(_RULESET_COND_SEEDS))      ruleset.kind = RULESET_SEEDS;
+	else if (tt == _RULESET_TT_OF(_RULESET_COND_REPLICATOR)) ruleset.kind = RULESET_REPLICATOR;
+	else if (tt == _RULESET_TT_OF(_RULESET_COND_LWOD))       ruleset.kind = RULESET_LWOD;
+	else                                                     ruleset.kind = RULESET_ANF;
+#endif
+}
+
+// evaluates `F(cond, ...)` with the condition for the current ruleset, which gives a `T`.
+// the kind doesn't change while the kernels are running, so the branch always predicts.
+// the wide neighborhoods only have the ANF, so there is nothing to pick.
+#if NH_WIDE
+	#define RULESET_EVAL(T, F, ...) ((T) F(_RULESET_COND_WIDE, __VA_ARGS__))
+#elif RUNTIME_RULESET
+	#define RULESET_EVAL(T, F, ...) ({                                                     \
+		T _out;                                                                           \
+		switch (ruleset.kind) {                                                           \
+		case RULESET_COMPILED:   _out = F(NEXT_COND, __VA_ARGS__); break;                  \
+		case RULESET_LIFE:       _out = F(_RULESET_COND_LIFE, __VA_ARGS__); break;         \
+		case RULESET_HIGHLIFE:   _out = F(_RULESET_COND_HIGHLIFE, __VA_ARGS__); break;     \
+		case RULESET_SEEDS:      _out = F(_RULESET_COND_SEEDS, __VA_ARGS__); break;        \
+		case RULESET_REPLICATOR: _out = F(_RULESET_COND_REPLICATOR, __VA_ARGS__); break;   \
+		case RULESET_LWOD:       _out = F(_RULESET_COND_LWOD, __VA_ARGS__); break;         \
+		default:                 _out = F(_RULESET_COND_ANF, __VA_ARGS__); break;          \
+		}                                                                                 \
+		_out;                                                                             \
+	})
+#else
+	#define RULESET_EVAL(T, F, ...) ((T) F(NEXT_COND, __VA_ARGS__))
+#endif
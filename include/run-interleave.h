@@ -0,0 +1,176 @@
+#pragma once
+#define RUN_INTERLEAVE_H
+
+// interleaved version of `run_once`, for when there is no SIMD_RUN. requires run.h.
+
+// a single trial is one long dependency chain: step the board, hash it, load the tags,
+// compare the key, and step again, and each part waits on the one before it. this keeps
+// `tune.width` trials (at most INTERLEAVE_K) going at once in the same thread, each with its
+// own hash table, and goes around them one step at a time, so the out of order window always
+// has that many chains that don't depend on each other. as soon as a trial steps, the slot
+// for its new state is prefetched, and the lookup for it only happens after the other
+// trials have had their turn, so the tags are usually already in L1 by then.
+
+// like run-simd.h, a finished trial is recorded right away and replaced with a new start
+// state, and the results for a list of start states are the same as `_run_once1` with
+// CYCLE_TABLE, just in a different order. the other cycle detectors and the memo need
+// `run_once`, so they turn this off.
+
+// the default width is 1, which doesn't use this at all, because on my machine it is a
+// little slower than `run_once`. the tables are small enough to stay in L1 anyway, and
+// Matx8_next is most of the time, which the out of order window already overlaps with the
+// lookup. `bnch run` compares them, and `--calibrate` picks the width for the machine.
+
+static HashTable ilv_tables[INTERLEAVE_K];
+
+static struct {
+	Matx8 state[INTERLEAVE_K];  // current state of each trial
+	Matx8 start[INTERLEAVE_K];  // start state of each trial
+	u32 hash[INTERLEAVE_K];     // Matx8_hash of each current state, from when it was prefetched
+	u32 step[INTERLEAVE_K];     // step index of each current state
+	u64 trial[INTERLEAVE_K];    // trial number of each trial (run.h)
+#if ATTRACTOR_CACHE
+	u32 cycles[INTERLEAVE_K];       // number of cached attractors when each trial started
+	Matx8 checked[INTERLEAVE_K];    // last state of each trial that was checked against the cache
+	u32 checked_step[INTERLEAVE_K]; // step index of each of those
+#endif
+	u32 active;                 // bitmask of the slots that have a trial in progress
+} ilv = {0};
+
+_Static_assert(INTERLEAVE_K >= 1 && INTERLEAVE_K <= 32, "the active slots are a 32-bit mask");
+
+static FORCE_INLINE void _ilv_prefetch(const u8 k) {
+	// hashes the current state of trial `k`, and starts loading the tags and the key of its
+	// home slot. the lookup might probe a little further, but it is almost always this line.
+	const HashTable *const table = ilv_tables + k;
+	const u32 h = Matx8_hash(ilv.state[k]);
+
+	ilv.hash[k] = h;
+	__builtin_prefetch(table->tags + h);
+	__builtin_prefetch(table->keys + h);
+}
+
+static FORCE_INLINE void _ilv_start(const u8 k, const Matx8 *const given) {
+	// starts a trial from `*given`, or from a new random state if it is NULL. the trial number
+	// is taken before the draw, so it is the one the state came from.
+	ilv.trial[k] = given != NULL ? Trial_given() : Trial_drawn();
+	const Matx8 start_state = given != NULL ? *given : Matx8_random();
+
+	HashTable_clear(ilv_tables + k);
+
+	ilv.start[k] = start_state;
+	ilv.state[k] = start_state;
+	ilv.step[k]  = 0;
+#if ATTRACTOR_CACHE
+	ilv.cycles[k]       = attractors.cycles;
+	ilv.checked[k]      = start_state;
+	ilv.checked_step[k] = 0;
+#endif
+	ilv.active |= 1u << k;
+
+	_ilv_prefetch(k);
+}
+
+static void _ilv_run3(u64 n, u64 starts, const Matx8 *restrict states) {
+	// runs until `n` trials have finished. finished trials are replaced while `starts` is
+	// nonzero. the start states come from `states` if it is given, and from `Matx8_random`
+	// otherwise. trials that are still running when this returns are kept for the next call.
+
+	for (u8 k = 0; k < tune.width && starts != 0; k++) {
+		if (ilv.active >> k & 1)
+			continue;
+
+		_ilv_start(k, states != NULL ? states++ : NULL);
+		starts--;
+	}
+
+	while (n != 0 && ilv.active != 0) {
+		// a fixed loop instead of going through the set bits, so it gets unrolled, and the
+		// trials' states can stay in registers. the set bits were about 20% slower. the slots
+		// past `tune.width` are never active.
+		#pragma GCC unroll 8
+		for (u8 k = 0; k < INTERLEAVE_K; k++) {
+			unlikely_if ((ilv.active >> k & 1) == 0)
+				continue;
+
+			HashTable *const table = ilv_tables + k;
+
+			const Matx8 state = ilv.state[k];
+			const u32 step    = ilv.step[k];
+			u32 period        = 0;
+
+		#if ATTRACTOR_CACHE
+			unlikely_if (step % ATTRACTOR_STRIDE == 0) {
+				period = Attractor_period(state, ilv.cycles[k]);
+
+				likelyp_if (period == 0, 0.97) {
+					ilv.checked[k]      = state;
+					ilv.checked_step[k] = step;
+				}
+			}
+		#endif
+
+			unlikelyp_if (period != 0, 0.97) {
+			#if ATTRACTOR_CACHE
+				Matx8 first = ilv.checked[k];
+				const u32 transient = Attractor_enter(&first, ilv.checked_step[k], ilv.cycles[k]);
+
+				run_trial = ilv.trial[k];
+				run_record(ilv.start[k], first, transient + period, period, table);
+			#endif
+			}
+			else {
+				const u32 table_value = HashTable_get_add(table, state, step, ilv.hash[k]);
+
+				likelyp_if (table_value == TABLE_NO_VALUE, 0.97129) {
+					ilv.state[k] = Matx8_next(state);
+					ilv.step[k]  = step + 1;
+					_ilv_prefetch(k);
+					continue;
+				}
+
+				run_trial = ilv.trial[k];
+
+				unlikelyp_if (table_value == TABLE_FULL, 0.9999999)
+					// too long for the trial's table, so start over with the spill table.
+					_run_once3(ilv.start[k], CYCLE_DETECT, MEMO_CACHE);
+				else {
+					run_record(ilv.start[k], state, step, step - table_value, table);
+
+				#if ATTRACTOR_CACHE
+					Attractor_add(state, step - table_value);
+				#endif
+				}
+			}
+
+			n--;
+			ilv.active &= ~(1u << k);
+
+			likely_if (starts != 0) {
+				_ilv_start(k, states != NULL ? states++ : NULL);
+				starts--;
+			}
+
+			unlikely_if (n == 0)
+				break;
+		}
+	}
+}
+
+static FORCE_INLINE void _ilv_run2(const u64 n, const Matx8 *restrict states) {
+	// run exactly `n` trials and wait for all of them to finish.
+	_ilv_run3(n, n, states);
+}
+
+static FORCE_INLINE void _ilv_run1(const u64 n) {
+	_ilv_run2(n, NULL);
+}
+
+// NOTE: this assumes there are no trials left over from `ilv_run_some`.
+#define ilv_run(n, states...) \
+	VA_IF(_ilv_run2(n, states), _ilv_run1(n), states)
+
+static FORCE_INLINE void ilv_run_some(const u64 n) {
+	// run `n` more trials, and keep all K going afterwards. this is for `nrun inf`.
+	_ilv_run3(n, UINT64_MAX, NULL);
+}
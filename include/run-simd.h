@@ -0,0 +1,157 @@
+#pragma once
+#define RUN_SIMD_H
+
+// multi-board version of `run_once`. requires run.h.
+
+// each lane of a Matx8xN holds an independent trajectory with its own hash table.
+// all the lanes are stepped together with one Matx8xN_next, and only the table
+// lookups are done one lane at a time. when a lane finds its repeat, the trial is
+// recorded and the lane is immediately refilled with a new start state, so every
+// lane is doing useful work until there are no trials left to start.
+
+// the trials still go through the same table logic as `_run_once1`, so the
+// results for a given list of start states are identical, just in a different order.
+
+#include "matx8-simd.h"
+
+static HashTable lane_tables[SIMD_LANES];
+
+static struct {
+	Matx8xN state;           // current state of each lane
+	Matx8 start[SIMD_LANES]; // start state of each lane
+	u32 step[SIMD_LANES];    // step index of the current state of each lane
+	u64 trial[SIMD_LANES];   // trial number of each lane (run.h)
+#if ATTRACTOR_CACHE
+	u32 cycles[SIMD_LANES];  // number of cached attractors when each lane's trial started
+	Matx8 checked[SIMD_LANES];     // last state of each lane that was checked against the cache
+	u32 checked_step[SIMD_LANES];  // step index of each of those
+#endif
+	u32 active;              // bitmask of the lanes that have a trial in progress
+} lanes = {0};
+
+static FORCE_INLINE void _simd_lane_start(const u8 lane, const Matx8 *const given) {
+	// starts a trial from `*given`, or from a new random state if it is NULL. the trial number
+	// is taken before the draw, so it is the one the state came from.
+	// the start state is added to the table here instead of in the main loop,
+	// because the main loop steps every lane right after the refill.
+	HashTable *const table = lane_tables + lane;
+
+	lanes.trial[lane] = given != NULL ? Trial_given() : Trial_drawn();
+	const Matx8 start_state = given != NULL ? *given : Matx8_random();
+
+	HashTable_clear(table);
+	HashTable_get_add(table, start_state, 0, Matx8_hash(start_state));
+
+	lanes.start[lane]        = start_state;
+	lanes.state.boards[lane] = start_state;
+	lanes.step[lane]         = 1;
+#if ATTRACTOR_CACHE
+	// the start state is never checked, but it is before the cycle or on it, which is all
+	// Attractor_enter needs.
+	lanes.cycles[lane]       = attractors.cycles;
+	lanes.checked[lane]      = start_state;
+	lanes.checked_step[lane] = 0;
+#endif
+	lanes.active            |= 1u << lane;
+}
+
+static void _simd_run3(u64 n, u64 starts, const Matx8 *restrict states) {
+	// runs until `n` trials have finished. finished lanes are refilled while
+	// `starts` is nonzero. the start states come from `states` if it is given,
+	// and from `Matx8_random` otherwise. lanes that are still running when
+	// this returns are kept for the next call.
+
+	for (u8 lane = 0; lane < SIMD_LANES && starts != 0; lane++) {
+		if (lanes.active >> lane & 1)
+			continue;
+
+		_simd_lane_start(lane, states != NULL ? states++ : NULL);
+		starts--;
+	}
+
+	while (n != 0 && lanes.active != 0) {
+		lanes.state = Matx8xN_next(lanes.state);
+
+		for (u32 pending = lanes.active; pending != 0; pending &= pending - 1) {
+			const u8 lane = __builtin_ctz(pending);
+			HashTable *const table = lane_tables + lane;
+
+			const Matx8 start = lanes.start[lane];
+			const Matx8 state = lanes.state.boards[lane];
+			const u32 step    = lanes.step[lane];
+			u32 period        = 0;
+
+		#if ATTRACTOR_CACHE
+			unlikely_if (step % ATTRACTOR_STRIDE == 0) {
+				period = Attractor_period(state, lanes.cycles[lane]);
+
+				likelyp_if (period == 0, 0.97) {
+					lanes.checked[lane]      = state;
+					lanes.checked_step[lane] = step;
+				}
+			}
+		#endif
+
+			unlikelyp_if (period != 0, 0.97) {
+			#if ATTRACTOR_CACHE
+				Matx8 first = lanes.checked[lane];
+				const u32 transient = Attractor_enter(&first, lanes.checked_step[lane], lanes.cycles[lane]);
+
+				run_trial = lanes.trial[lane];
+				run_record(start, first, transient + period, period, table);
+			#endif
+			}
+			else {
+				const u32 table_value = HashTable_get_add(table, state, step, Matx8_hash(state));
+
+				likelyp_if (table_value == TABLE_NO_VALUE, 0.97129) {
+					lanes.step[lane] = step + 1;
+					continue;
+				}
+
+				run_trial = lanes.trial[lane];
+
+				unlikelyp_if (table_value == TABLE_FULL, 0.9999999)
+					// too long for the lane's table, so start over with the spill table.
+					_run_once3(start, CYCLE_DETECT, MEMO_CACHE);
+				else {
+					run_record(start, state, step, step - table_value, table);
+
+				#if ATTRACTOR_CACHE
+					Attractor_add(state, step - table_value);
+				#endif
+				}
+			}
+
+			n--;
+			lanes.active &= ~(1u << lane);
+
+			likely_if (starts != 0) {
+				_simd_lane_start(lane, states != NULL ? states++ : NULL);
+				starts--;
+			}
+
+			unlikely_if (n == 0)
+				break;
+		}
+	}
+}
+
+static FORCE_INLINE void _simd_run2(const u64 n, const Matx8 *restrict states) {
+	// run exactly `n` trials and wait for all of them to finish.
+	_simd_run3(n, n, states);
+}
+
+static FORCE_INLINE void _simd_run1(const u64 n) {
+	_simd_run2(n, NULL);
+}
+
+// NOTE: this assumes there are no lanes left over from `simd_run_some`.
+#define simd_run(n, states...) \
+	VA_IF(_simd_run2(n, states), _simd_run1(n), states)
+
+static FORCE_INLINE void simd_run_some(const u64 n) {
+	// run `n` more trials, and keep the lanes full afterwards.
+	// this is for `nrun inf`, where there is never a last trial to wait for.
+	_simd_run3(n, UINT64_MAX, NULL);
+}
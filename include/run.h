@@ -1,7 +1,100 @@
 #pragma once
 #define RUN_H
 
-static void log_if_interesting(Matx8 s0, Matx8 s1, sttyp_t type, u32 step, u32 period) {
+// the periods and transients past the end of `data`, for the rare trial that is longer. the
+// main histograms are for the common values, and these store the sparse remaining ones,
+// sorted by value, like `bws_hist2`.
+
+typedef struct {
+	u32 key;
+	u64 count;
+} LongHistEntry;
+
+typedef struct {
+	u32 len, cap;
+	LongHistEntry *list;
+} LongHist;
+
+static LongHist long_periods = {0}, long_transients = {0};
+
+static u32 _long_hist_index(const LongHist *const restrict hist, const u32 key) {
+	// the index of `key`, or where it would go if it isn't there.
+	u32 lo = 0, hi = hist->len;
+
+	while (lo < hi) {
+		const u32 mid = lo + (hi - lo >> 1);
+
+		if (hist->list[mid].key < key)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static u64 LongHist_get(const LongHist *const restrict hist, const u32 key) {
+	const u32 i = _long_hist_index(hist, key);
+	return i < hist->len && hist->list[i].key == key ? hist->list[i].count : 0;
+}
+
+static void LongHist_add(LongHist *const restrict hist, const u32 key) {
+	const u32 i = _long_hist_index(hist, key);
+
+	if (i < hist->len && hist->list[i].key == key) {
+		hist->list[i].count++;
+		return;
+	}
+
+	if (hist->len == hist->cap) {
+		// 50% increase each time it runs out of space
+		hist->cap  = hist->cap == 0 ? 16 : hist->cap*3 >> 1;
+		hist->list = realloc(hist->list, hist->cap * sizeof(LongHistEntry));
+		OOM(hist->list, 13);
+	}
+
+	memmove(hist->list + i + 1, hist->list + i, (hist->len - i) * sizeof(LongHistEntry));
+	hist->list[i] = (LongHistEntry) {.key = key, .count = 1};
+	hist->len++;
+}
+
+static FORCE_INLINE void LongHist_clear(void) {
+	// empties both of them, for when `data` is cleared.
+	long_periods.len    = 0;
+	long_transients.len = 0;
+}
+
+// the number of the trial that is being recorded, for the logs and TRAJFILE. the engines set it
+// right before `run_record`, because the trials don't always finish in the order they started.
+static u64 run_trial = 0;
+static u64 run_started = 0; // trials started so far, for the numbers that aren't draws
+
+static FORCE_INLINE u64 Trial_drawn(void) {
+	// the number of a trial whose start state is the next one drawn. with COUNTER_RAND, it is
+	// the draw it starts at over RAND_WORDS, so `-g SEED:TRIAL` runs that trial first, whatever
+	// order the trials finish in, and `nrun inf` resetting the summary doesn't change it.
+#if COUNTER_RAND
+	run_started++;
+	return _claim_trial();
+#else
+	return run_started++;
+#endif
+}
+
+static FORCE_INLINE u64 Trial_given(void) {
+	// the number of a trial with a start state that wasn't drawn for it (`run STATE`, strat).
+	// there is no draw to replay, so it is just the order it started in, from 0.
+	return run_started++;
+}
+
+static void log_if_interesting(
+	const Board s0,
+	const Board s1,
+	sttyp_t type,
+	u32 step,
+	u32 period,
+	const HashTable *const restrict table
+) {
 	// returns an integer where the magnitude reflects how interesting the state is.
 	u8 interest = 0;
 
@@ -13,31 +106,35 @@ static void log_if_interesting(Matx8 s0, Matx8 s1, sttyp_t type, u32 step, u32 p
 	// the 64 and 128 conditions are so unlikely that I have never actually seen them.
 	static u8 b4 = 5, b32 = 5;
 
+	const u64 transients = step <= TRANSIENT_MAX ? data.transients[step] : LongHist_get(&long_transients, step);
+	const u64 periods    = period <= PERIOD_MAX ? data.periods[period] : LongHist_get(&long_periods, period);
+
 	// rare but not new transient value.
-	unlikely_if (data.transients[step] < 2 && data.transients[step] > 0)
+	unlikely_if (transients < 2 && transients > 0)
 		interest |= 1 << 0; // 1
 
 	// rare but not new period value
-	unlikely_if (data.periods[period] < 2 && data.periods[period] > 0)
+	unlikely_if (periods < 2 && periods > 0)
 		interest |= 1 << 1; // 2
 
 	// a lot of states before the loop, and a loop
-	unlikely_if (step - period > 196 && period > 36) {
+	unlikely_if (step - period > LOG_TRANSIENT && period > LOG_PERIOD) {
 		unlikelyp_if (b4 != 0, 0.999) b4--;
 
 		interest |= 1 << 2; // 4
 	}
 
 	// new transient value
-	unlikely_if (data.transients[step] == 0)
+	unlikely_if (transients == 0)
 		interest |= 1 << 3; // 8
 
 	// new period value
-	unlikely_if (data.periods[period] == 0)
+	unlikely_if (periods == 0)
 		interest |= 1 << 4; // 16
 
-	// constant end state and slightly less than half of the states
-	unlikely_if (type == CONST && 26 < POPCNT(s1.matx) && POPCNT(s1.matx) < 32) {
+	// constant end state and slightly less than half of the states. (26, 32) for 8x8
+	unlikely_if (type == CONST && BOARD_CELLS*13/32 < Board__popcnt_u(s1.matx) &&
+		Board__popcnt_u(s1.matx) < BOARD_CELLS/2) {
 		unlikelyp_if (b32 != 0, 0.999) b32--;
 
 		interest |= 1 << 5; // 32
@@ -45,11 +142,11 @@ static void log_if_interesting(Matx8 s0, Matx8 s1, sttyp_t type, u32 step, u32 p
 
 	// the start and end states total the whole board
 	// this is only interesting if the final state isn't empty
-	unlikelyp_if (type != EMPTY && (s0.matx | s1.matx) == ~0llu, 0.99999)
+	unlikelyp_if (type != EMPTY && Board__full_u(s0.matx | s1.matx), 0.99999)
 		interest |= 1 << 6; // 64
 
 	// the two states are perfect inverses of each other.
-	unlikelyp_if ((s0.matx ^ s1.matx) == ~0llu, 0.99999) {
+	unlikelyp_if (Board__full_u(s0.matx ^ s1.matx), 0.99999) {
 		// way more interesting than 2, so remove that one if this one is true.
 		interest &= ~2;
 		interest |= 1 << 7; // 128
@@ -88,17 +185,20 @@ static void log_if_interesting(Matx8 s0, Matx8 s1, sttyp_t type, u32 step, u32 p
 	 * per: period (if interesting)
 	 * trs: transient length (if interesting)
 	 * n: number of things that were interesting (if greater than 1)
-	 * trial: the current trial number.
+	 * trial: the trial number (run_trial). with COUNTER_RAND, `-g SEED:TRIAL` runs it first.
 	**/
 
+	char start[BOARD_STR_LEN];
+	Board_sprint(start, s0);
+
 	// this will just print `365-17:00:00.000` every time in profiling mode.
-	printf("\n%03d-%02d:%02d:%02d.%03d | %#018zx | %3u | ",
+	printf("\n%03d-%02d:%02d:%02d.%03d | %s | %3u | ",
 		tm->tm_yday + 1,              // DAY: 001-366
 		tm->tm_hour,                  // HH: 00-23
 		tm->tm_min,                   // MM
 		tm->tm_sec,                   // SS
 		(int) (ts.tv_nsec / 1000000), // MS
-		s0.matx, interest
+		start, interest
 	);
 
 	// pick the alignment based on the length of the max value, up to 6 digits.
@@ -167,79 +267,167 @@ static void log_if_interesting(Matx8 s0, Matx8 s1, sttyp_t type, u32 step, u32 p
 		printf( "  | ");
 
 	// print the trial number last because it will mess up the columns otherwise.
-	print_du64(data.counts[EMPTY] + data.counts[CONST] + data.counts[CYCLE]);
+	print_du64(run_trial);
+
+	unlikely_if (cfg.traj_out)
+		Trajectory_write(s0, step, period, table, run_trial);
 }
 
-static void _run_once1(const Matx8 start_state) {
-	u32 step, h, table_value, period;
-	Matx8 state = start_state;
+static void run_record(
+	const Board start_state,
+	const Board state,
+	const u32 step,
+	const u32 period,
+	const HashTable *const restrict table
+) {
+	// adds a finished trial to the global data.
+	// `state` is the first repeated state, `step` is the index it was found at.
+	// `table` is the hash table the trial ran with, or NULL, for the trajectory and DEBUG.
+
+	sttyp_t type = Board__empty_u(state.matx) ? EMPTY : period == 1 ? CONST : CYCLE;
+
+	// update this one first so the logs work properly.
+	++data.counts[type];
 
-	Table_clear();
+	likely_if (!cfg.quiet)
+		log_if_interesting(start_state, state, type, step, period, table);
+
+	// update the global data. the values past the end go in the long histograms.
+	likelyp_if (step <= TRANSIENT_MAX, 0.9999999)
+		++data.transients[step];
+	else
+		LongHist_add(&long_transients, step);
+
+	likelyp_if (period <= PERIOD_MAX, 0.9999999)
+		++data.periods[period];
+	else
+		LongHist_add(&long_periods, period);
+
+#if DEBUG
+	const u32 collisions = table != NULL ? table->collisions : 0;
+
+	if (collisions > max_collisions) {
+		max_collisions = collisions;
+		max_collisions_state = start_state;
+	}
+#endif
+}
+
+static void _run_once_error(const char *const restrict what, const Board start_state, const u32 step) {
+	char start[BOARD_STR_LEN];
+	Board_sprint(start, start_state);
+	eprintf("\n%s: s=%s, step=%u", what, start, step);
+}
+
+static FORCE_INLINE void _run_once_done(
+	const Board start_state,
+	const Board end,
+	const u32 transient,
+	const u32 period,
+	const HashTable *const restrict table,
+	const bool memoize
+) {
+	// `end` is the first state on the cycle, and `transient` is its index.
+#if MEMO_CACHE
+	if (memoize)
+		Memo_finish(end, transient, period);
+#else
+	(void) memoize;
+#endif
+
+	run_record(start_state, end, transient + period, period, table);
+}
+
+static FORCE_INLINE void _run_once3(const Board start_state, const u8 how, const bool memoize) {
+	// `how` is the cycle detector (cycle.h), and `memoize` is whether to use the memo
+	// (memo.h). they are always constants.
+	u32 step;
+	u8 status;
+	Board state = start_state;
+
+#define _RUN_ONCE_TABLE (how == CYCLE_TABLE || how == CYCLE_SYMMETRY ? &hashtable : NULL)
+
+#if ATTRACTOR_CACHE
+	// the last state that was checked against the attractor cache, and its index.
+	Board checked    = start_state;
+	u32 checked_step = 0;
+#endif
+
+#if MEMO_CACHE
+	if (memoize)
+		Memo_clear_points();
+#endif
+
+	Cycle_clear(start_state, how);
 
 	for (step = 0;; step++) {
-		h = Matx8_hash(state);
-		table_value = Table_get(state, h);
+	#if ATTRACTOR_CACHE
+		unlikely_if (step % ATTRACTOR_STRIDE == 0) {
+			const u32 period = Attractor_period(state);
 
-		unlikelyp_if (table_value != TABLE_NO_VALUE, 0.92129) {
-			// this happens after on average 34.83 iterations., or 2.87% of the time.
+			unlikelyp_if (period != 0, 0.97) {
+				step = Attractor_enter(&checked, checked_step, attractors.cycles);
+				_run_once_done(start_state, checked, step, period, _RUN_ONCE_TABLE, memoize);
+				return;
+			}
 
-			// the state has already been seen.
-			period = step - table_value;
-			break;
+			checked      = state;
+			checked_step = step;
 		}
+	#endif
 
-		unlikelyp_if (Table_add(state, step, h), 0.9999999) {
-			eprintf("\nArena OOM: s=%#018zx, step=%u", start_state.matx, step);
-			return;
-		}
+	#if MEMO_CACHE
+		// the start state is random, so it is basically never in the memo.
+		unlikely_if (memoize && step % MEMO_STRIDE == 0 && step != 0) {
+			const u64 fp = Symmetry_fingerprint(state);
+			u32 left, period;
+			Board end;
 
-		state = Matx8_next(state);
-	}
+			unlikelyp_if (Memo_get(fp, state, &end, &left, &period), 0.9) {
+				_run_once_done(start_state, end, step + left, period, _RUN_ONCE_TABLE, memoize);
+				return;
+			}
 
-	// make sure the indices are valid and won't segfault the program.
-	u8 invalid = 0; // 2 bit value
+			Memo_point(fp, state, step);
+		}
+	#endif
 
-	unlikelyp_if (period > PERIOD_MAX, 0.9999999)
-		invalid |= 1;
+		status = Cycle_add(state, step, how);
 
-	unlikelyp_if (step > TRANSIENT_MAX, 0.9999999)
-		invalid |= 2;
+		unlikelyp_if (status != CYCLE_NONE, 0.92129)
+			break;
 
-	unlikelyp_if (invalid != 0, 0.9999999) {
-		eprintf(
-			"\ninvalid start state: out of bounds value, reason=\"%s\""
-			": p=%03u, t=%03u, s=%#018zx",
-			invalid == 1 ? "p" : invalid == 2 ? "p+t"+2 : "p+t",
-			period,
-			step,
-			start_state.matx
-		);
+		state = Board_next(state);
+	}
 
+	unlikelyp_if (status != CYCLE_FOUND, 0.9999999) {
+		_run_once_error(cycle_errors[status], start_state, step);
 		return;
 	}
 
-	sttyp_t type = state.matx == 0 ? EMPTY : period == 1 ? CONST : CYCLE;
+	step = Cycle_finish(&state, step, how);
 
-	// update this one first so the logs work properly.
-	++data.counts[type];
+#if BOARD_SIZE == 8
+	if (how == CYCLE_SYMMETRY)
+		Symmetry_count(cycle.symmetry);
+#endif
 
-	likely_if (!cfg.quiet)
-		log_if_interesting(start_state, state, type, step, period);
+#if ATTRACTOR_CACHE
+	Attractor_add(state, cycle.period);
+#endif
 
-	// update the global data
-	++data.transients[step];
-	++data.periods[period];
+	_run_once_done(start_state, state, step - cycle.period, cycle.period, _RUN_ONCE_TABLE, memoize);
+#undef _RUN_ONCE_TABLE
+}
 
-#if DEBUG
-	if (hashtable.arena_pos > max_collisions) {
-		max_collisions = hashtable.arena_pos;
-		max_collisions_state = start_state.matx;
-	}
-#endif
+static void _run_once1(const Board start_state) {
+	run_trial = Trial_given();
+	_run_once3(start_state, CYCLE_DETECT, MEMO_CACHE);
 }
 
 static FORCE_INLINE void _run_once0(void) {
-	_run_once1(Matx8_random());
+	run_trial = Trial_drawn();
+	_run_once3(Board_random(), CYCLE_DETECT, MEMO_CACHE);
 }
 
 #define run_once(start_state...) \
@@ -248,12 +436,55 @@ static FORCE_INLINE void _run_once0(void) {
 #define RUN_2() ({run_once(); run_once();})
 #define RUN_8() ({RUN_2(); RUN_2(); RUN_2(); RUN_2();})
 
+#if SIMD_RUN
+	#include "run-simd.h"
+
+	// keep the lanes full between batches instead of draining them every time.
+	#define RUN_32() simd_run_some(32)
+#elif INTERLEAVE_RUN
+	#include "run-interleave.h"
+
+	#define RUN_32() ({                             \
+		if (tune.width > 1)                         \
+			ilv_run_some(32);                       \
+		else                                        \
+			({RUN_8(); RUN_8(); RUN_8(); RUN_8();}); \
+	})
+#else
+	// 32 copies of the `call run_once` instruction.
+	#define RUN_32() ({RUN_8(); RUN_8(); RUN_8(); RUN_8();})
+#endif
+
+static void run_save(void) {
+	// writes the summary to the data file, and starts the next one from nothing, for the
+	// commands that run for longer than TIMER_PERIOD.
+	give_summary(SUM_RETURN); // returning version of the function. never uses the clipboard
+	Table_reset();               // the summary was written in `hashtable.scratch`
+
+	memset(data.raw, 0, DATA_SIZE); // clear periods, transients, and counts arrays at once.
+	LongHist_clear();
+#if COUNTER_RAND
+	Claim_reset();
+#endif
+#if CYCLE_DETECT == CYCLE_SYMMETRY
+	memset(symmetry.tfm_counts, 0, sizeof symmetry.tfm_counts);
+	memset(symmetry.roll_counts, 0, sizeof symmetry.roll_counts);
+#endif
+}
+
 static void run_forever(void) {
 	u64 last_reset = (u64) _time64(NULL);
 start:
 	bool update_pressed = false;
 
 	while (true) {
+	#if COUNTER_RAND
+		// the trials for the loop below. if it is stopped partway through, the rest of them
+		// are never run by anything.
+		unlikely_if (claims.permute)
+			Claim_next((u64) INT16_MAX * UINT8_MAX * 32);
+	#endif
+
 		// only check the timer like every 64 to 515 seconds or so,
 		// depending on how fast your computer is.
 		for (u16 j = 0; j < INT16_MAX; j++) {
@@ -261,9 +492,8 @@ start:
 			// sometimes if you just tap the stop or update button, it will miss it.
 			// pressing and holding for a slightest amount of time fixes it.
 			for (u8 i = 0; i < UINT8_MAX; i++) {
-				// run 32 trials. 32 copies of the `call run_once` instruction.
-				RUN_8(); RUN_8();
-				RUN_8(); RUN_8();
+				// run 32 trials.
+				RUN_32();
 			}
 
 			// if you are pressing both keys, print the trial first and then exit.
@@ -292,10 +522,7 @@ start:
 			continue;
 
 		last_reset = now;
-		give_summary(SUM_RETURN); // returning version of the function. never uses the clipboard
-		Table_clear();
-
-		memset(data.raw, 0, DATA_SIZE); // clear periods, transients, and counts arrays at once.
+		run_save();
 
 		enputs("More than " TOSTRING_EXPANDED(TIMER_PERIOD)
 			" seconds have passed since timer last check. restarting.");
@@ -10,22 +10,36 @@ static FORCE_INLINE char *_stringify_count(const sttyp_t t) {
 	}
 }
 
-static void print_state(const Matx8 state) {
-	// returns the number of characters printed (always 202)
+static void print_state(const Board state) {
 	// represents alive cells as '#' and dead cells as '.'
+	// the column numbers are mod 10 for the bigger boards.
 
 	// this function doesn't need to be optimized because it runs in the `sim`
 	// branches, where the code deliberately calls `Sleep`.
 
+#if BOARD_SIZE == 8
 	puts(
 		"   | 7 6 5 4 3 2 1 0 \n"
 		"---+-----------------"
 	);
+#else
+	printf("%*s|", INT_LEN(BOARD_SIZE - 1) + 2, "");
 
-	for (u8 row = 8; row --> 0 ;) {
-		printf(" %u |", row);
+	for (u8 col = BOARD_SIZE; col --> 0 ;)
+		printf(" %u", col % 10);
 
-		for (u8 col = 8; col --> 0 ;) {
+	printf(" \n%.*s+", INT_LEN(BOARD_SIZE - 1) + 2, "----");
+
+	for (u8 col = 0; col < 2*BOARD_SIZE + 1; col++)
+		putchar('-');
+
+	putchar('\n');
+#endif
+
+	for (u8 row = BOARD_SIZE; row --> 0 ;) {
+		printf(" %*u |", INT_LEN(BOARD_SIZE - 1), row);
+
+		for (u8 col = BOARD_SIZE; col --> 0 ;) {
 			putchar(' ');
 			putchar((state.rows[row] >> col) & 1 ? cfg.sim_chars.alive : cfg.sim_chars.dead);
 		}
@@ -35,18 +49,19 @@ static void print_state(const Matx8 state) {
 	}
 }
 
+#if BOARD_SIZE == 8
 static void _cli_sim2(const u64 trial, const Matx8 start_state) {
-	u32 step, h, table_value, period;
+	u32 step = 0;
+	u8 status;
 	Matx8 state = start_state;
 
-	Table_clear();
+	Cycle_clear(start_state, CYCLE_DETECT);
 
 	unlikely_if (cfg.silent) {
 		do {
 			Sleep(cfg.sleep_ms.state);
 
-			if (unlikelyp(Table_get(state) != TABLE_NO_VALUE, 0.97129) ||
-				unlikelyp(Table_add(state, 0), 0.999999))
+			unlikelyp_if (Cycle_add(state, step++, CYCLE_DETECT) != CYCLE_NONE, 0.97129)
 				return;
 
 			state = Matx8_next(state);
@@ -61,21 +76,19 @@ static void _cli_sim2(const u64 trial, const Matx8 start_state) {
 	printf("\e[Hstate %3u:          \n", 0);
 	print_state(state);
 
-	step = 0;
-
 	do {
 		Sleep(cfg.sleep_ms.state);
-		h = Matx8_hash(state);
-		table_value = Table_get(state, h);
+		status = Cycle_add(state, step, CYCLE_DETECT);
 
-		unlikelyp_if (table_value != TABLE_NO_VALUE, 0.97129) {
-			// the state has already been seen.
-			period = step - table_value;
+		unlikelyp_if (status == CYCLE_FOUND, 0.97129) {
+			// the state has already been seen. Brent and Nivasch show a few extra states
+			// before they notice, but the transient and period are still exact.
+			step = Cycle_finish(&state, step, CYCLE_DETECT);
 			goto sim_done;
 		}
 
-		unlikelyp_if (Table_add(state, step, h), 0.999999) {
-			eprintf("Arena OOM: s=%#018zx, step=%u\n", start_state.matx, step);
+		unlikelyp_if (status != CYCLE_NONE, 0.999999) {
+			eprintf("%s: s=%#018zx, step=%u\n", cycle_errors[status], start_state.matx, step);
 			return;
 		}
 
@@ -97,17 +110,17 @@ static void _cli_sim2(const u64 trial, const Matx8 start_state) {
 sim_done:
 	printf("\e[4;22Hs=0x%018zx", start_state.matx);
 	printf("\e[5;22Hd=\"%s\"",
-		_stringify_count(!state.matx ? EMPTY : period == 1 ? CONST : CYCLE));
-	printf("\e[6;22Hp=%u", period);
+		_stringify_count(!state.matx ? EMPTY : cycle.period == 1 ? CONST : CYCLE));
+	printf("\e[6;22Hp=%u", cycle.period);
 	printf("\e[7;22Ht=%u", step);
 	printf("\e[8;22HT="); print_du64(trial);
 
 #if DEBUG
-	printf("\e[9;22HC=%u", hashtable.arena_pos);
+	printf("\e[9;22HC=%u", hashtable.collisions);
 
-	if (hashtable.arena_pos > max_collisions) {
-		max_collisions = hashtable.arena_pos;
-		max_collisions_state = start_state.matx;
+	if (hashtable.collisions > max_collisions) {
+		max_collisions = hashtable.collisions;
+		max_collisions_state = start_state;
 	}
 #endif
 
@@ -153,3 +166,5 @@ static FORCE_INLINE void _cli_sim_one0(void) {
 
 #define cli_sim_one(start_state...) \
 	VA_IF(_cli_sim_one1(start_state), _cli_sim_one0(), start_state)
+
+#endif // BOARD_SIZE == 8
@@ -0,0 +1,325 @@
+#pragma once
+#define STRAT_H
+
+// `nrun strat N`: about N random trials, stratified by the population of the start state, with
+// the histograms reweighted so they are still an estimate of N uniform random trials.
+// requires run.h.
+
+// stratum k is the start states with k cells alive, which are W_k = binomial(64, k) / 2^64 of
+// all of them. `nrun` puts about W_k of its trials in each one, but the outcome varies a lot
+// more in some of them than others: low populations almost always die, and high ones almost
+// always die in one step. taking n_k trials from stratum k and weighting each of them by
+// W_k / n_k is unbiased for any n_k, and the Neyman allocation, n_k proportional to W_k times
+// the standard deviation of the outcome in stratum k, has the least variance for N trials.
+
+// the outcome is the three counts, so the standard deviation is from empty, const, and cycle,
+// and it is the best allocation for those, not for every period and transient. it comes from a
+// pilot of 1/STRAT_PILOT of the trials, spread out like `nrun` would, but with at least one in
+// every stratum. the pilot and the rest are each unbiased, so the summary is both of them added.
+
+// the histograms are integers, so each stratum's weighted counts are rounded with one random
+// offset u for all of them: a bin gets the points u, u + 1, u + 2, ... that fall in its part of
+// the stratum's weighted total. that is still unbiased, and every histogram gets the same number
+// of points, so the periods, the transients, and the counts all add up to the trials. while it
+// runs, `data` has the unweighted counts, so the logs are the same as `nrun`, and the summary has
+// the weighted ones, marked "weighted" so analyze.py doesn't add them to the unweighted ones.
+
+// a state is picked out of its stratum by setting each bit with probability q = j/16, the j
+// that needs the fewest draws for population k, and trying again until there are k of them.
+// given the population, every state is as likely as the others, whatever q is. each try is
+// one draw for each binary digit of q, and it takes about 10 tries for the strata most of
+// the trials are in. the draws come from a second stream of the seed, so the start states
+// aren't the seed's trial numbers, and there are no ranges in the summary, or claims from
+// `-p`. with CYCLE_SYMMETRY, the symmetry counts are weighted like the rest.
+
+#define STRAT_LEN	(BOARD_CELLS + 1)  // populations 0 to 64
+#define STRAT_PILOT	16                 // 1/16 of the trials are the pilot
+#define STRAT_BATCH	(UINT8_MAX * 32)   // start states made at a time
+
+static struct {
+	u64 binom[STRAT_LEN][STRAT_LEN]; // binom[n][k]. binomial(64, 32) still fits in a u64
+	u64 hits[STRAT_LEN][3];          // the counts from the last trials of each stratum
+	u64 draws;                       // random numbers used for the states and the rounding
+	u8 q16[STRAT_LEN];               // 16 times the probability of each bit for each stratum
+	bool weighted;                   // whether `data` has the weighted histograms, for the summary
+	typeof(data) prev, out;          // `data` before the current stratum, and the weighted data
+	LongHist prev_periods, prev_transients, out_periods, out_transients;
+#if CYCLE_DETECT == CYCLE_SYMMETRY
+	typeof(symmetry.tfm_counts) prev_tfms, out_tfms;
+	typeof(symmetry.roll_counts) prev_rolls, out_rolls;
+#endif
+} strat = {0};
+
+static FORCE_INLINE u64 _strat_random(void) {
+#if COUNTER_RAND
+	// a second stream from the same key, so the trial numbers don't move.
+	return _rand_mix(~rng.key + strat.draws++ * 0x9e3779b97f4a7c15llu);
+#else
+	return Matx8_random().matx;
+#endif
+}
+
+static FORCE_INLINE double _strat_uniform(void) {
+	// a random number in [0, 1) for the rounding.
+	return (_strat_random() >> 11) * 0x1p-53;
+}
+
+static FORCE_INLINE u64 _strat_points(const double x, const double u) {
+	// the number of the points u, u + 1, u + 2, ... below `x`.
+	return x > u ? (u64) (x - u) + 1 : 0;
+}
+
+static FORCE_INLINE u64 _strat_take(u64 *const restrict seen, const u64 count, const double scale, const double u) {
+	// the points in the next `count` of the histogram's weighted total, after the `seen` before it.
+	// each bin gets `scale * count` of them on average, and the bins add up to the whole total's.
+	const u64 before = _strat_points(scale * *seen, u);
+	*seen += count;
+	return _strat_points(scale * *seen, u) - before;
+}
+
+static void _strat_q16_init(void) {
+	// picks j for each stratum, with the fewest expected draws: the digits of j/16 after the
+	// last one that is set, over the probability that 64 bits with probability j/16 have k.
+	strat.q16[0]           = 0;
+	strat.q16[BOARD_CELLS] = 16;
+
+	for (u8 k = 1; k < BOARD_CELLS; k++) {
+		double best = 0.0;
+
+		for (u8 j = 1; j < 16; j++) {
+			// binomial(64, k) q^k (1 - q)^(64 - k), without pow.
+			double p = strat.binom[64][k];
+
+			for (u8 i = 0; i < BOARD_CELLS; i++)
+				p *= i < k ? j / 16.0 : 1 - j / 16.0;
+
+			const double score = p / (4 - __builtin_ctz(j)); // tries per draw
+			if (score > best) {
+				best         = score;
+				strat.q16[k] = j;
+			}
+		}
+	}
+}
+
+static Matx8 _strat_state(const u8 k) {
+	// a uniform random state with population k.
+	const u8 j = strat.q16[k];
+
+	unlikely_if (j == 0 || j == 16)
+		return (Matx8) {.matx = j == 0 ? 0 : ~0llu};
+
+	while (true) {
+		// the binary digits of q from the last one, so each bit is 1 with probability j/16.
+		// `| r` adds 1/2 to the probability and halves the rest, and `& r` just halves it.
+		u64 state = 0;
+
+		for (u8 d = __builtin_ctz(j); d < 4; d++)
+			state = j >> d & 1 ? state | _strat_random() : state & _strat_random();
+
+		unlikelyp_if (POPCNT(state) == k, 0.9)
+			return (Matx8) {.matx = state};
+	}
+}
+
+static void _strat_long_save(LongHist *const restrict dst, const LongHist *const restrict src) {
+	unlikely_if (dst->cap < src->len) {
+		dst->cap  = src->cap;
+		dst->list = realloc(dst->list, dst->cap * sizeof(LongHistEntry));
+		OOM(dst->list, 18);
+	}
+
+	memcpy(dst->list, src->list, src->len * sizeof(LongHistEntry));
+	dst->len = src->len;
+}
+
+static void _strat_long_add(
+	LongHist *const restrict out,
+	const LongHist *const restrict now,
+	const LongHist *const restrict prev,
+	const double scale,
+	const double u,
+	u64 *const restrict seen
+) {
+	// adds the weighted entries that are new since `prev` to `out`. there are hardly ever any.
+	for (u32 i = 0; i < now->len; i++) {
+		const u64 count = now->list[i].count - LongHist_get(prev, now->list[i].key);
+
+		for (u64 c = _strat_take(seen, count, scale, u); c --> 0 ;)
+			LongHist_add(out, now->list[i].key);
+	}
+}
+
+static void _strat_run_states(const Matx8 *const restrict states, const u64 n) {
+	// the same engines as `nrun`, but with the given start states.
+#if SIMD_RUN
+	simd_run(n, states);
+#else
+#if INTERLEAVE_RUN
+	if (tune.width > 1)
+		ilv_run(n, states);
+	else
+#endif
+	{
+		for (u64 i = 0; i < n; i++)
+			run_once(states[i]);
+	}
+#endif
+}
+
+static void _strat_stratum(const u8 k, const u64 n, const double scale, Matx8 *const restrict states) {
+	// runs `n` trials with population k, and adds them to `strat.out` weighted by `scale`.
+	memcpy(strat.prev.raw, data.raw, DATA_SIZE);
+	_strat_long_save(&strat.prev_periods, &long_periods);
+	_strat_long_save(&strat.prev_transients, &long_transients);
+#if CYCLE_DETECT == CYCLE_SYMMETRY
+	memcpy(strat.prev_tfms, symmetry.tfm_counts, sizeof strat.prev_tfms);
+	memcpy(strat.prev_rolls, symmetry.roll_counts, sizeof strat.prev_rolls);
+#endif
+
+	for (u64 left = n; left != 0 ;) {
+		const u64 len = left < STRAT_BATCH ? left : STRAT_BATCH;
+
+		for (u64 i = 0; i < len; i++)
+			states[i] = _strat_state(k);
+
+		_strat_run_states(states, len);
+		left -= len;
+	}
+
+	// one offset for the whole stratum, and each histogram starts over from it.
+	const double u = _strat_uniform();
+	u64 seen = 0;
+
+	for (u32 i = 0; i < PERIOD_LEN; i++)
+		strat.out.periods[i] += _strat_take(&seen, data.periods[i] - strat.prev.periods[i], scale, u);
+
+	_strat_long_add(&strat.out_periods, &long_periods, &strat.prev_periods, scale, u, &seen);
+	seen = 0;
+
+	for (u32 i = 0; i < TRANSIENT_LEN; i++)
+		strat.out.transients[i] += _strat_take(&seen, data.transients[i] - strat.prev.transients[i], scale, u);
+
+	_strat_long_add(&strat.out_transients, &long_transients, &strat.prev_transients, scale, u, &seen);
+	seen = 0;
+
+	for (u8 t = 0; t < 3; t++) {
+		strat.hits[k][t]     = data.counts[t] - strat.prev.counts[t];
+		strat.out.counts[t] += _strat_take(&seen, strat.hits[k][t], scale, u);
+	}
+
+#if CYCLE_DETECT == CYCLE_SYMMETRY
+	seen = 0;
+
+	for (u8 i = 0; i < 8; i++)
+		strat.out_tfms[i] += _strat_take(&seen, symmetry.tfm_counts[i] - strat.prev_tfms[i], scale, u);
+
+	seen = 0;
+
+	for (u8 i = 0; i < 64; i++)
+		strat.out_rolls[i] += _strat_take(&seen, symmetry.roll_counts[i] - strat.prev_rolls[i], scale, u);
+#endif
+}
+
+static double _strat_sigma(const u8 k, const u64 n) {
+	// the standard deviation of the counts in stratum k, from its `n` pilot trials. a third of
+	// a trial is added to each count, so a stratum where every trial ended the same way still
+	// gets some of the trials.
+	double var = 0.0;
+
+	for (u8 t = 0; t < 3; t++) {
+		const double p = (strat.hits[k][t] + 1.0/3) / (n + 1);
+		var += p * (1 - p);
+	}
+
+	return __builtin_sqrt(var);
+}
+
+static void strat_run(const u64 n) {
+	// runs about `n` stratified trials, and puts the weighted histograms in `data`.
+	Matx8 *const states = malloc(STRAT_BATCH * sizeof(Matx8));
+	OOM(states, 18);
+
+	double weight[STRAT_LEN], sigma[STRAT_LEN];
+	u64 pilot[STRAT_LEN], rest[STRAT_LEN], pilots = 0, rests = 0;
+
+	for (u8 i = 0; i < STRAT_LEN; i++) {
+		strat.binom[i][0] = 1;
+
+		for (u8 j = 1; j <= i; j++)
+			strat.binom[i][j] = strat.binom[i - 1][j - 1] + strat.binom[i - 1][j];
+	}
+
+	_strat_q16_init();
+
+#if COUNTER_RAND
+	claims.none = true;
+
+	unlikely_if (claims.permute && !cfg.silent)
+		ewputs("`nrun strat` doesn't use the seed's trial numbers, so `-p` doesn't do anything.");
+#endif
+
+	for (u8 k = 0; k < STRAT_LEN; k++) {
+		weight[k] = strat.binom[64][k] * 0x1p-64;
+		pilot[k]  = (u64) (n / STRAT_PILOT * weight[k] + 0.5);
+		pilot[k] += pilot[k] == 0;
+		pilots   += pilot[k];
+	}
+
+	for (u8 k = 0; k < STRAT_LEN; k++)
+		_strat_stratum(k, pilot[k], pilots * weight[k] / pilot[k], states);
+
+	// the Neyman allocation of the rest, with at least one in every stratum again.
+	double total = 0.0, var_sum = 0.0, p_all[3] = {0};
+
+	for (u8 k = 0; k < STRAT_LEN; k++) {
+		sigma[k] = _strat_sigma(k, pilot[k]);
+		total   += weight[k] * sigma[k];
+		var_sum += weight[k] * sigma[k] * sigma[k];
+
+		for (u8 t = 0; t < 3; t++)
+			p_all[t] += weight[k] * (strat.hits[k][t] + 1.0/3) / (pilot[k] + 1);
+	}
+
+	const u64 left = n > pilots ? n - pilots : 0;
+
+	for (u8 k = 0; k < STRAT_LEN; k++) {
+		rest[k]  = (u64) (left * weight[k] * sigma[k] / total + 0.5);
+		rest[k] += rest[k] == 0;
+		rests   += rest[k];
+	}
+
+	for (u8 k = 0; k < STRAT_LEN; k++)
+		_strat_stratum(k, rest[k], rests * weight[k] / rest[k], states);
+
+	free(states);
+
+	likely_if (!cfg.quiet && !cfg.silent) {
+		// the variance of a uniform trial's counts over the stratified one's, for the pilot's
+		// estimates. the uniform one also has the part from the strata having different means.
+		double var_uniform = 0.0;
+
+		for (u8 t = 0; t < 3; t++)
+			var_uniform += p_all[t] * (1 - p_all[t]);
+
+		printf("\n%zu pilot trials and %zu Neyman allocated ones. nrun would need about %.3g times"
+			" as many for the same error in the counts (%.3g with the same allocation as nrun)\n",
+			pilots, rests, var_uniform / (total * total), var_uniform / var_sum);
+	}
+
+	// the weighted histograms replace the unweighted ones.
+	memcpy(data.raw, strat.out.raw, DATA_SIZE);
+#if CYCLE_DETECT == CYCLE_SYMMETRY
+	memcpy(symmetry.tfm_counts, strat.out_tfms, sizeof strat.out_tfms);
+	memcpy(symmetry.roll_counts, strat.out_rolls, sizeof strat.out_rolls);
+#endif
+
+	free(long_periods.list);
+	free(long_transients.list);
+	free(strat.prev_periods.list);
+	free(strat.prev_transients.list);
+
+	long_periods    = strat.out_periods;
+	long_transients = strat.out_transients;
+	strat.weighted  = true;
+}
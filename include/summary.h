@@ -86,6 +86,11 @@ void comptime_error(void) __attribute__((error("")));
 #endif
 
 static char *sprintf_summary(char *buf);
+static char *sprintf_summary_hists(char *buf);
+#if CYCLE_DETECT == CYCLE_SYMMETRY
+static char *sprintf_summary_symmetries(char *buf);
+#endif
+static void give_summary_buf(char *buf_stt, char *buf_end, bool returns);
 #if BWSEARCH
 static char *bws_sprintf_summary(char *buf);
 static void _give_summary(bool returns, bool direction);
@@ -100,17 +105,63 @@ static void _give_summary(bool returns);
 static char *sprintf_summary(char *buf) {
 	// assumes the input buffer is at least like 8 KiB long
 
+	// the ruleset is first so objects from different rulesets are easy to tell apart.
+	buf += sprintf(buf, "{\n\t\"ruleset\": \"%s\",", ruleset.str);
+
+#if BOARD_SIZE != 8
+	// objects without this are 8x8. analyze.py only combines objects with the same size.
+	BUF_WRITE(buf, "\n\t\"board\": %u,", BOARD_SIZE);
+#endif
+
+#if NEIGHBORHOOD != NH_MOORE || NH_CENTER
+	// objects without this are MOORE. analyze.py only combines objects with the same one.
+	BUF_WRITE(buf, "\n\t\"neighborhood\": \"" NH_NAME NH_CENTER_NAME "\",");
+#endif
+
+#if STRAT
+	// the histograms of `nrun strat` are weighted, not counts of trials (strat.h). analyze.py
+	// keeps these objects apart from the others, and doesn't give them binomial intervals.
+	if (strat.weighted)
+		BUF_WRITE(buf, "\n\t\"weighted\": true,");
+#endif
+
+#if COUNTER_RAND
+	// the seed and trial numbers the trials came from (claim.h). analyze.py keeps the ranges
+	// for each seed, and merges the ones that overlap.
+	if (rng.seeded)
+		buf = sprintf_summary_ranges(buf);
+#endif
+
 #if DEBUG
-	BUF_WRITE(buf, "{\n\t\"hcollide\": {\"count\": %u, \"states\": [\"%#018zx\"]},"
+	char state[BOARD_STR_LEN];
+	Board_sprint(state, max_collisions_state);
+
+	buf += sprintf(buf, "\n\t\"hcollide\": {\"count\": %u, \"states\": [\"%s\"]},"
 		"\n\t\"trials\": [\"",
-		max_collisions, max_collisions_state
+		max_collisions, state
 	);
 #else
-	BUF_WRITE(buf, "{\n\t\"hcollide\": {\"count\": 0, \"states\": [\"0x0000000000000000\"]},\n\t\"trials\": [\"");
+	BUF_WRITE(buf, "\n\t\"hcollide\": {\"count\": 0, \"states\": [\"0x0000000000000000\"]},\n\t\"trials\": [\"");
 #endif
 	BUF_WRITE(buf, data.counts[EMPTY] + data.counts[CONST] + data.counts[CYCLE]);
+	BUF_WRITE(buf, "\", \"0\"],");
 
-	BUF_WRITE(buf, "\", \"0\"],\n\t\"counts\": {\"empty\": \"");
+	buf = sprintf_summary_hists(buf);
+
+#if CYCLE_DETECT == CYCLE_SYMMETRY
+	buf = sprintf_summary_symmetries(buf);
+#endif
+
+	BUF_WRITE(buf, "\n\t\"indegrees\": {}\n}");
+
+	*buf = '\0';
+
+	return buf; // return a pointer to the null terminator byte.
+}
+
+static char *sprintf_summary_hists(char *buf) {
+	// writes the counts, periods, and transients from `data`, with a comma after them.
+	BUF_WRITE(buf, "\n\t\"counts\": {\"empty\": \"");
 	BUF_WRITE(buf, data.counts[EMPTY]);
 	BUF_WRITE(buf, "\", \"const\": \""); BUF_WRITE(buf, data.counts[CONST]);
 	BUF_WRITE(buf, "\", \"cycle\": \""); BUF_WRITE(buf, data.counts[CYCLE]);
@@ -119,13 +170,13 @@ static char *sprintf_summary(char *buf) {
 	// this stuff compiles to AVX512 instructions if they are available.
 	{
 		u32 max_period = 0;
-		for (u32 i = PERIOD_MAX; i --> 0 ;)
+		for (u32 i = PERIOD_LEN; i --> 0 ;)
 			if (data.periods[i] != 0) {
 				max_period = i;
 				break;
 			}
 
-		for (u32 i = 0; i < PERIOD_MAX; i++) {
+		for (u32 i = 0; i < PERIOD_LEN; i++) {
 			unlikely_if (i == max_period) {
 				BUF_WRITE(buf, "\"%u\": %zu", i, data.periods[i]);
 				break;
@@ -137,18 +188,22 @@ static char *sprintf_summary(char *buf) {
 			BUF_WRITE(buf, "\"%u\": %zu", i, data.periods[i]);
 			BUF_WRITE(buf, ',', ' ');
 		}
+
+		// there is always at least one entry before these, even if it is 0.
+		for (u32 i = 0; i < long_periods.len; i++)
+			BUF_WRITE(buf, ", \"%u\": %zu", long_periods.list[i].key, long_periods.list[i].count);
 	} // end bare block
 
 	BUF_WRITE(buf, "},\n\t\"transients\": {");
 	{
 		u32 max_transient = 0;
-		for (u32 i = TRANSIENT_MAX; i --> 0 ;)
+		for (u32 i = TRANSIENT_LEN; i --> 0 ;)
 			if (data.transients[i] != 0) {
 				max_transient = i;
 				break;
 			}
 
-		for (u32 i = 0; i < TRANSIENT_MAX; i++) {
+		for (u32 i = 0; i < TRANSIENT_LEN; i++) {
 			unlikely_if (i == max_transient) {
 				BUF_WRITE(buf, "\"%u\": %zu", i, data.transients[i]);
 				break;
@@ -160,19 +215,54 @@ static char *sprintf_summary(char *buf) {
 			BUF_WRITE(buf, "\"%u\": %zu", i, data.transients[i]);
 			BUF_WRITE(buf, ',', ' ');
 		}
+
+		for (u32 i = 0; i < long_transients.len; i++)
+			BUF_WRITE(buf, ", \"%u\": %zu", long_transients.list[i].key, long_transients.list[i].count);
 	} // end bare block
 
-	BUF_WRITE(buf, "},\n\t\"indegrees\": {}\n}");
+	BUF_WRITE(buf, '}', ',');
 
-	*buf = '\0';
+	return buf;
+}
 
-	return buf; // return a pointer to the null terminator byte.
+#if CYCLE_DETECT == CYCLE_SYMMETRY
+static char *sprintf_summary_symmetries(char *buf) {
+	// writes the transforms and the rolls (x,y) of the symmetries that the cycles were found
+	// with, with a comma after them. the trials that the attractor cache or the memo finished
+	// never got to the cycle detector, so they aren't counted.
+	const char *sep = "";
+
+	BUF_WRITE(buf, "\n\t\"symmetries\": {");
+
+	for (u8 tfm = 0; tfm < 8; tfm++) {
+		if (symmetry.tfm_counts[tfm] == 0)
+			continue;
+
+		buf += sprintf(buf, "%s\"%s\": %zu", sep, tfm_strs[tfm], symmetry.tfm_counts[tfm]);
+		sep = ", ";
+	}
+
+	BUF_WRITE(buf, "},\n\t\"displacements\": {");
+	sep = "";
+
+	for (u8 i = 0; i < 64; i++) {
+		if (symmetry.roll_counts[i] == 0)
+			continue;
+
+		buf += sprintf(buf, "%s\"%u,%u\": %zu", sep, i % 8, i / 8, symmetry.roll_counts[i]);
+		sep = ", ";
+	}
+
+	BUF_WRITE(buf, '}', ',');
+
+	return buf;
 }
+#endif
 
 #if BWSEARCH
 static char *bws_sprintf_summary(char *buf) {
+	buf += sprintf(buf, "{\n\t\"ruleset\": \"%s\",", ruleset.str);
 	BUF_WRITE(buf,
-		"{"
 		"\n\t\"hcollide\": {\"count\": 0, \"states\": [\"0x0000000000000000\"]},"
 		"\n\t\"trials\": [\"0\", \""
 	);
@@ -229,18 +319,37 @@ static void _give_summary(const bool returns)
 #endif
 {
 	// TODO: consider perhaps using malloc/free if the scratch buffer isn't large enough.
-	// basically this is a static assert of this: TABLE_LEN + ARENA_LEN >= 512
+	// table.h never makes SCRATCH_SIZE smaller than this.
 	_Static_assert(SCRATCH_SIZE >= 8*1024,
 		"SCRATCH_SIZE must be at least 8 KiB for `sprintf_sumary` and `bws_sprintf_sumary`"
 	);
 
-	char *const buf_stt = hashtable.scratch;
+	// the long histograms (run.h) can make it longer than that, but they are almost always empty.
+	u64 long_size = (long_periods.len + long_transients.len) * 32;
+
+#if COUNTER_RAND
+	// and so can a lot of separate `-p` ranges.
+	long_size += claims.len * 48;
+#endif
+
+	char *const buf_stt = likely(long_size == 0) ? hashtable.scratch : malloc(SCRATCH_SIZE + long_size);
+	OOM(buf_stt, 13);
+
 #if BWSEARCH
 	char *buf_end = (direction == SUM_BACKWARDS ? bws_sprintf_summary : sprintf_summary)(buf_stt);
 #else
 	char *buf_end = sprintf_summary(buf_stt);
 #endif
 
+	give_summary_buf(buf_stt, buf_end, returns);
+
+	if (buf_stt != hashtable.scratch)
+		free(buf_stt);
+}
+
+static void give_summary_buf(char *const buf_stt, char *buf_end, const bool returns) {
+	// prints the summary in `buf_stt`, and writes it to the clipboard and the datafile.
+	// `buf_end` points to its null terminator, and there has to be room for 3 more bytes.
 	likely_if (!cfg.silent) {
 		if (cfg.quiet)
 			printf("\r\e[K");
@@ -0,0 +1,242 @@
+#pragma once
+#define SWEEP_H
+
+// `swep`: random trials for a whole list of rulesets in one process. requires run.h.
+
+// every lane of a Matx8xN runs the trials for its own ruleset. the ANF coefficients are
+// vectors with one ruleset per lane (see _RULESET_COND_ANF_WITH), so one step advances
+// SIMD_LANES different rulesets at once. when a lane finishes the trials for its ruleset,
+// the summary is given, and the lane moves on to the next ruleset in the list.
+
+// the color dual of a ruleset (see Ruleset_dual) steps the complement of each board to
+// the complement of its next board, so the complement of a trial is a trial of the dual
+// with the same transient and period. if a ruleset and its dual are both given, only one
+// of them is run, and the dual summary comes from the complement of the same trials. the
+// only thing that changes is which end states are empty, so the trials that end on the
+// full board are counted as well.
+
+#include "matx8-simd.h"
+
+typedef struct {
+	u16 tt;    // truth table
+	u16 dual;  // truth table of the color dual
+	bool pair; // the dual was also given, and is summarized from the same trials
+} SweepRule;
+
+static HashTable sweep_tables[SIMD_LANES];
+static typeof(data) sweep_data[SIMD_LANES]; // histograms for the ruleset in each lane
+
+static struct {
+	Matx8xN state;                     // current state of each lane
+	u64xN anf[16];                     // ANF coefficients of the ruleset in each lane
+	Matx8 start[SIMD_LANES];           // start state of each lane
+	u32 step[SIMD_LANES];              // step index of the current state of each lane
+	u64 left[SIMD_LANES];              // trials left for the ruleset in each lane
+	u64 full[SIMD_LANES][2];           // trials that ended on the full board. [1] is period 1
+	const SweepRule *rule[SIMD_LANES]; // ruleset of each lane
+	const SweepRule *next, *end;       // rulesets that haven't been given to a lane yet
+	u64 trials;                        // trials per ruleset
+	u32 active;                        // bitmask of the lanes that have a ruleset
+} sweep = {0};
+
+// bit tt is set if the ruleset was given and hasn't been given a run yet.
+static u64 sweep_given[(1 << 16) / 64];
+
+#define _SWEEP_GIVEN(tt) (sweep_given[(tt) >> 6] >> ((tt) & 63) & 1)
+
+static const char *sweep_add(u16 *const restrict list, u32 *const restrict count, const char *restrict str) {
+	// adds `B.../S...`, a truth table, or an inclusive range of truth tables like `A-B` to
+	// the list. rulesets that were already given are skipped. returns an error message, or NULL.
+	u64 lo, hi;
+
+	if ((*str | 32) == 'b' || (*str | 32) == 's') {
+		u16 tt;
+		const char *const error = Ruleset_parse(&tt, str);
+
+		unlikely_if (error != NULL)
+			return error;
+
+		lo = hi = tt;
+	}
+	else {
+		char *end;
+
+		lo = hi = strtoull(str, &end, 0);
+
+		unlikely_if (end == str)
+			return "expected a ruleset, truth table, or range";
+
+		if (*end == '-') {
+			str = end + 1;
+			hi  = strtoull(str, &end, 0);
+
+			unlikely_if (end == str)
+				return "expected a truth table after `-`";
+		}
+
+		unlikely_if (*end != '\0')
+			return "unexpected characters after the truth table";
+
+		unlikely_if (hi > UINT16_MAX || lo > hi)
+			return "truth tables are 16 bits, and ranges can't be backwards";
+
+		// in a range, these are skipped instead, since they are copies of other rulesets.
+		unlikely_if (lo == hi && (lo & ~_RULESET_CARE) != 0)
+			return "truth table has bits set that the neighborhood can't use";
+	}
+
+	for (u64 tt = lo; tt <= hi; tt++) {
+		if ((tt & ~_RULESET_CARE) != 0 || _SWEEP_GIVEN(tt))
+			continue;
+
+		sweep_given[tt >> 6] |= 1llu << (tt & 63);
+		list[(*count)++] = tt;
+	}
+
+	return NULL;
+}
+
+static u32 sweep_pair(SweepRule *const restrict rules, const u16 *const restrict list, const u32 count) {
+	// turns the list from `sweep_add` into the rulesets to run, in the same order. if both
+	// rulesets of a dual pair were given, only the first one is run. returns the number of runs.
+	u32 runs = 0;
+
+	for (u32 i = 0; i < count; i++) {
+		const u16 tt = list[i], dual = Ruleset_dual(tt);
+
+		if (!_SWEEP_GIVEN(tt))
+			continue; // it is the dual of an earlier one
+
+		sweep_given[tt >> 6] &= ~(1llu << (tt & 63));
+
+		const bool pair = dual != tt && _SWEEP_GIVEN(dual);
+
+		if (pair)
+			sweep_given[dual >> 6] &= ~(1llu << (dual & 63));
+
+		rules[runs++] = (SweepRule) {.tt = tt, .dual = dual, .pair = pair};
+	}
+
+	return runs;
+}
+
+static FORCE_INLINE void _sweep_trial_start(const u8 lane) {
+	// the same as `_simd_lane_start`, but the ruleset stays the same.
+	HashTable *const table = sweep_tables + lane;
+	const Matx8 start_state = Matx8_random();
+
+	HashTable_clear(table);
+	HashTable_get_add(table, start_state, 0, Matx8_hash(start_state));
+
+	sweep.start[lane]        = start_state;
+	sweep.state.boards[lane] = start_state;
+	sweep.step[lane]         = 1;
+}
+
+static void _sweep_lane_rule(const u8 lane) {
+	// gives the lane the next ruleset, or makes it inactive if there are none left.
+	unlikely_if (sweep.next == sweep.end) {
+		sweep.active &= ~(1u << lane);
+		return;
+	}
+
+	const SweepRule *const rule = sweep.rule[lane] = sweep.next++;
+	const u16 anf = Ruleset_anf(rule->tt);
+
+	for (u8 x = 0; x < 16; x++)
+		sweep.anf[x][lane] = -(u64) (anf >> x & 1);
+
+	memset(sweep_data[lane].raw, 0, DATA_SIZE);
+	sweep.full[lane][0] = sweep.full[lane][1] = 0;
+	sweep.left[lane]    = sweep.trials;
+	sweep.active       |= 1u << lane;
+
+	_sweep_trial_start(lane);
+}
+
+static FORCE_INLINE void _sweep_record(const u8 lane, const Matx8 state, const u32 step, const u32 period) {
+	// the same as `run_record`, but into the histograms for the lane, and without the logs.
+	typeof(data) *const d = sweep_data + lane;
+
+	unlikelyp_if (period > PERIOD_MAX || step > TRANSIENT_MAX, 0.9999999) {
+		char name[24];
+		Ruleset_sprint(name, sweep.rule[lane]->tt);
+
+		eprintf("\ninvalid start state: out of bounds value, r=%s: p=%03u, t=%03u, s=%#018zx",
+			name, period, step, sweep.start[lane].matx);
+
+		return;
+	}
+
+	++d->counts[state.matx == 0 ? EMPTY : period == 1 ? CONST : CYCLE];
+	++d->transients[step];
+	++d->periods[period];
+
+	unlikely_if (state.matx == ~0llu)
+		++sweep.full[lane][period == 1];
+}
+
+static void _sweep_summary(const u8 lane) {
+	const SweepRule *const rule = sweep.rule[lane];
+
+	memcpy(data.raw, sweep_data[lane].raw, DATA_SIZE);
+	Ruleset_set(NULL, rule->tt);
+	give_summary(SUM_RETURN);
+
+	if (!rule->pair)
+		return;
+
+	// the complement of every trial. the periods and transients are the same.
+	const u64 *const full = sweep.full[lane];
+	const u64 trials = data.counts[EMPTY] + data.counts[CONST] + data.counts[CYCLE];
+
+	data.counts[EMPTY] = full[0] + full[1];
+	data.counts[CONST] = data.periods[1] - full[1];
+	data.counts[CYCLE] = trials - data.counts[EMPTY] - data.counts[CONST];
+
+	Ruleset_set(NULL, rule->dual);
+	give_summary(SUM_RETURN);
+}
+
+static void sweep_run(const SweepRule *const rules, const u32 count, const u64 n) {
+	// runs `n` random trials for each ruleset and gives a summary for each one. the
+	// summaries are in the order the rulesets finish, which is usually the list order.
+	sweep.next   = rules;
+	sweep.end    = rules + count;
+	sweep.trials = n;
+
+	for (u8 lane = 0; lane < SIMD_LANES; lane++)
+		_sweep_lane_rule(lane);
+
+	while (sweep.active != 0) {
+		// the lanes without a ruleset are stepped as well, but nothing reads them.
+		sweep.state.matx = _MATX8_NEXT_EVAL(_RULESET_COND_ANF_WITH(sweep.anf), COUNTER, u64xN,
+			NEIGHBORHOOD, sweep.state.matx, Matx8xN__xroll_u, Matx8xN__yroll_u);
+
+		for (u32 pending = sweep.active; pending != 0; pending &= pending - 1) {
+			const u8 lane = __builtin_ctz(pending);
+			HashTable *const table = sweep_tables + lane;
+
+			const Matx8 state = sweep.state.boards[lane];
+			const u32 step    = sweep.step[lane];
+			const u32 table_value = HashTable_get_add(table, state, step, Matx8_hash(state));
+
+			likelyp_if (table_value == TABLE_NO_VALUE, 0.97129) {
+				sweep.step[lane] = step + 1;
+				continue;
+			}
+
+			unlikelyp_if (table_value == TABLE_FULL, 0.9999999)
+				eprintf("\nTransient OOM: s=%#018zx, step=%u", sweep.start[lane].matx, step);
+			else
+				_sweep_record(lane, state, step, step - table_value);
+
+			likely_if (--sweep.left[lane] != 0)
+				_sweep_trial_start(lane);
+			else {
+				_sweep_summary(lane);
+				_sweep_lane_rule(lane);
+			}
+		}
+	}
+}
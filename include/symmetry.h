@@ -0,0 +1,132 @@
+#pragma once
+#define SYMMETRY_H
+
+// defines Symmetry and the Symmetry_* API, for CYCLE_SYMMETRY (cycle.h) and the memo (memo.h).
+// requires board.h, and only works on 8x8 boards.
+
+// Matx8_next commutes with the rolls, and with the transforms that map the neighborhood to
+// itself. a symmetry is one of those transforms followed by a roll, in the same order as
+// Board_tfm, and the orbit of a state is every state that a symmetry maps it to.
+
+// finding the smallest state of the orbit would take 8 transforms and 64 rolls, so the
+// orbits are told apart by a fingerprint that is the same for every state in them instead:
+// the popcount, and the number of pairs of alive cells at a few distances. two states with
+// the same fingerprint are usually in the same orbit, but Symmetry_find has to check.
+
+typedef struct {
+	u8 tfm;  // TFM_*
+	u8 x, y; // rolls, done after the transform
+} Symmetry;
+
+static struct {
+	u8 tfms;             // bitmask of the TFM_* transforms that commute with Matx8_next
+
+	// the symmetries that CYCLE_SYMMETRY found the trials' cycles with, for the summary.
+	u64 tfm_counts[8];   // by transform
+	u64 roll_counts[64]; // by roll, y*8 + x
+} symmetry = {0};
+
+// the neighborhood drawn around (3, 3), like _NH_PLANE. the offsets are all in [-2, 2].
+#define _SYMMETRY_NH_BIT(x, y, ...) | 1llu << ((3 + (y))*8 + 3 + (x))
+
+static void Symmetry_init(void) {
+	// finds the transforms that map the neighborhood to itself. the center moves with the
+	// transform, so the image is rolled back to put it at (3, 3) before comparing.
+	const u64 nh = 0 NH_OFFSETS(_SYMMETRY_NH_BIT, 0);
+
+	symmetry.tfms = 0;
+
+	for (u8 tfm = 0; tfm < 8; tfm++) {
+		const u8 c = __builtin_ctzll(Matx8__tfm_u(1llu << 27, tfm));
+		const u64 image = Matx8__yroll_u(Matx8__xroll_u(Matx8__tfm_u(nh, tfm), c % 8 - 3), c / 8 - 3);
+
+		symmetry.tfms |= (image == nh) << tfm;
+	}
+}
+
+static FORCE_INLINE Matx8 Symmetry_apply(const Matx8 state, const Symmetry g) {
+	return Board_tfm(state, g.tfm, g.x, g.y);
+}
+
+static FORCE_INLINE void Symmetry_count(const Symmetry g) {
+	symmetry.tfm_counts[g.tfm]++;
+	symmetry.roll_counts[g.y*8 + g.x]++;
+}
+
+static FORCE_INLINE u32 _symmetry_pairs(const u64 s, const u8 x, const u8 y) {
+	// alive cells that have another alive cell at (x, y) from them.
+	return POPCNT(s & Matx8__yroll_u(Matx8__xroll_u(s, x), y));
+}
+
+static FORCE_INLINE u64 Symmetry_fingerprint(const Matx8 state) {
+	// the same for every state in an orbit. each sum is over every offset that one of the
+	// transforms can map the first one to, so it works for any subset of the transforms.
+	const u64 s = state.matx;
+
+	const u64 a = POPCNT(s);
+	const u64 b = _symmetry_pairs(s, 1, 0) + _symmetry_pairs(s, 0, 1);
+	const u64 c = _symmetry_pairs(s, 1, 1) + _symmetry_pairs(s, 1, 7);
+	const u64 d = _symmetry_pairs(s, 2, 0) + _symmetry_pairs(s, 0, 2);
+	const u64 e = _symmetry_pairs(s, 2, 1) + _symmetry_pairs(s, 1, 2) + _symmetry_pairs(s, 2, 7) + _symmetry_pairs(s, 1, 6);
+	const u64 f = _symmetry_pairs(s, 2, 2) + _symmetry_pairs(s, 2, 6);
+	const u64 g = _symmetry_pairs(s, 3, 0) + _symmetry_pairs(s, 0, 3);
+	const u64 h = _symmetry_pairs(s, 3, 1) + _symmetry_pairs(s, 1, 3) + _symmetry_pairs(s, 3, 7) + _symmetry_pairs(s, 1, 5);
+
+	// each one is at most 256, so they get 9 bits each. the low bit is so it is never 0.
+	const u64 lo = a << 45 | b << 36 | c << 27 | d << 18 | e << 9 | f;
+	const u64 hi = g << 9 | h;
+
+	return (lo * 0x9e3779b97f4a7c15llu ^ hi * 0xc2b2ae3d27d4eb4fllu) | 1;
+}
+
+static FORCE_INLINE u64 Symmetry_key(const Matx8 state) {
+	// a cheaper fingerprint, for CYCLE_SYMMETRY, which needs one for every step. it only has
+	// the first few classes, so different orbits match more often, but the states of a
+	// single trajectory mostly look different anyway. about 1.9x faster than the full one.
+	const u64 s = state.matx;
+
+	const u64 a = POPCNT(s);
+	const u64 b = _symmetry_pairs(s, 1, 0) + _symmetry_pairs(s, 0, 1);
+	const u64 c = _symmetry_pairs(s, 1, 1) + _symmetry_pairs(s, 1, 7);
+	const u64 d = _symmetry_pairs(s, 2, 0) + _symmetry_pairs(s, 0, 2);
+
+	return (a << 27 | b << 18 | c << 9 | d) * 0x9e3779b97f4a7c15llu;
+}
+
+static FORCE_INLINE u64 _symmetry_row_counts(const u64 s) {
+	// the popcount of each row, in the byte for that row.
+	u64 c = s - (s >> 1 & 0x5555555555555555llu);
+	c = (c & 0x3333333333333333llu) + (c >> 2 & 0x3333333333333333llu);
+	return c + (c >> 4) & 0x0f0f0f0f0f0f0f0fllu;
+}
+
+static bool Symmetry_find(const Matx8 from, const Matx8 to, Symmetry *const restrict g) {
+	// if a symmetry maps `from` to `to`, sets `g` to it and returns true. the x rolls don't
+	// change the row popcounts, and the y rolls rotate them, so only the y rolls that line
+	// them up are worth trying every x roll for.
+	const u64 rows = _symmetry_row_counts(to.matx);
+
+	for (u8 tfm = 0; tfm < 8; tfm++) {
+		if ((symmetry.tfms >> tfm & 1) == 0)
+			continue;
+
+		const u64 p = Matx8__tfm_u(from.matx, tfm);
+		const u64 p_rows = _symmetry_row_counts(p);
+
+		for (u8 y = 0; y < 8; y++) {
+			likely_if (Matx8__yroll_u(p_rows, y) != rows)
+				continue;
+
+			const u64 q = Matx8__yroll_u(p, y);
+
+			for (u8 x = 0; x < 8; x++) {
+				unlikely_if (Matx8__xroll_u(q, x) == to.matx) {
+					*g = (Symmetry) {.tfm = tfm, .x = x, .y = y};
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
@@ -1,136 +1,247 @@
 #pragma once
 #define TABLE_H
 
-// defines TableEntry, HashTable, and the Table_* API
+// defines HashTable, the HashTable_* API, and the Table_* API
 
 #include "matx8.h"
 
-#define TABLE_LEN (1 << TABLE_BITS)
+// open addressing with linear probing. each slot has a 16-bit tag, which is the generation
+// in the high byte and 8 more hash bits in the low byte, and the tags are checked 8 at a time
+// with SSE2. a slot is only in use if its generation is the current one, so clearing the
+// table is just incrementing the generation, and the tags are only actually zeroed when it
+// wraps around, which is once every 255 trials.
+
+// the probes don't wrap around to the start. instead, there are TRANSIENT_LEN more slots
+// after the TABLE_LEN home slots. a HashTable never has more than TRANSIENT_LEN states, so a
+// probe can never run off the end.
+
+// the global table (the Table_* API) keeps going past that for the rare trial that is
+// longer, with the spill table. that one is on the heap, and only exists while such a trial
+// is running. it starts at 2*TRANSIENT_LEN slots, doubles whenever it is half full, and the
+// next Table_clear frees it, so the common trials still only touch the fixed table, and
+// they don't pay anything for it besides a check in Table_clear.
+
+// the number of home slots is set at runtime (tune.table_bits), so the arrays are allocated
+// for the most it can be, and the smaller sizes just leave the end of them unused.
+#define TABLE_LEN     (1u << tune.table_bits)
+#define TABLE_LEN_MAX (1 << TABLE_BITS_MAX)
+#define TABLE_SLOTS   (TABLE_LEN_MAX + TRANSIENT_LEN)
+
+_Static_assert(2 <= TABLE_BITS && TABLE_BITS <= TABLE_BITS_MAX && TABLE_BITS_MAX <= 24,
+	"TABLE_BITS has to be at least 2, and at most TABLE_BITS_MAX, which is at most 24");
 
 #define TABLE_NO_VALUE  (~0u)
-#define ARENA_NO_BUCKET (~0u)
-#define ARENA_NO_NEXT  ((~0u) - 1u)
+#define TABLE_FULL      ((~0u) - 1u)
 
-// each entry takes up a quarter of a cache line.
-typedef struct {
-	Matx8 key; // the matrix. 8 bytes
-	u32 val;   // step index the state belongs to.
-	u32 next;  // arena id for the next entry in the linked list.
-} __attribute__((aligned(16))) TableEntry;
+// bytes for each slot. the keys, values, and tags are separate arrays.
+#define TABLE_SLOT_SIZE (sizeof(Matx8) + 2*sizeof(u16))
 
-#define SCRATCH_SIZE ((TABLE_LEN + ARENA_LEN)*sizeof(TableEntry) + 1*sizeof(u32))
+_Static_assert(TRANSIENT_LEN < UINT16_MAX, "the values are 16-bit step indices");
+
+// the 8 tags after the last slot are never used, so the last probe can load 8 tags at once.
+#define _TABLE_SIZE (TABLE_SLOTS*TABLE_SLOT_SIZE + 8*sizeof(u16) + 4*sizeof(u32))
+#define SCRATCH_SIZE (_TABLE_SIZE > 8*1024 ? _TABLE_SIZE : 8*1024)
 
 typedef union {
 	// generic byte buffer for storing strings in some parts of the program.
 	// this just uses the same memory location as the hash table, but is not part of it.
 	char scratch[SCRATCH_SIZE];
 
-	// NOTE: The first layer of entries is directly in the hash table. Usually
-	//       the hashmap is an array of pointers, but I like this way better.
-	__attribute__((packed)) struct {
-		TableEntry buckets[TABLE_LEN];
-		TableEntry overflow_arena[ARENA_LEN];
-		u32 arena_pos; // next write index
+	struct {
+		Matx8 keys[TABLE_SLOTS];
+		u16 vals[TABLE_SLOTS];    // step index each state belongs to
+		u16 tags[TABLE_SLOTS + 8]; // generation << 8 | tag bits. 0 is never a generation
+		u32 len;                   // number of states in the table
+		u32 collisions;            // number of states that aren't in their home slot
+		u32 tail;                  // number of slots past TABLE_LEN that were used
+		u8 gen;                    // current generation
 	};
 } __attribute__((aligned(64))) HashTable; // aligned to a cache line.
 
+typedef u16 _u16x8 __attribute__((vector_size(16)));
+typedef char _i8x16 __attribute__((vector_size(16)));
+
 static HashTable hashtable = {0};
 
 #if DEBUG
 static u64 total_collisions = 0;
 #endif
 
-static bool Table__add3(const Matx8 mat, const u32 val, const u32 h) {
-	// returns true if it is out of memory and false otherwise
+static FORCE_INLINE u16 _table_tag(const Matx8 mat) {
+	// the 8 bits of the hash right under the ones Matx8_hash uses for the index.
+	return (u8) (mat.matx * 0xff51afd7ed558ccdllu >> (56 - tune.table_bits));
+}
 
-	if (hashtable.buckets[h].next == ARENA_NO_BUCKET) {
-		// no collision.
-		hashtable.buckets[h] = (TableEntry) {
-			.key  = mat,
-			.val  = val,
-			.next = ARENA_NO_NEXT
-		};
+static FORCE_INLINE u32 HashTable_get_add(
+	HashTable *const restrict table,
+	const Matx8 mat,
+	const u32 val,
+	const u32 h
+) {
+	// returns the value for `mat` if it is in the table. otherwise, it adds `mat` with the
+	// value `val` and returns TABLE_NO_VALUE, or TABLE_FULL if it already has TRANSIENT_LEN states.
+	const u16 tag = (u16) table->gen << 8 | _table_tag(mat);
+
+	for (u32 i = h;; i += 8) {
+		_u16x8 tags;
+		memcpy(&tags, table->tags + i, sizeof tags);
+
+		// 2 bits for each slot. only the low one is kept for the matches.
+		const u32 empty = __builtin_ia32_pmovmskb128((_i8x16) (tags >> 8 != table->gen));
+		u32 match = __builtin_ia32_pmovmskb128((_i8x16) (tags == tag)) & 0x5555;
+
+		// only the slots before the first empty one are part of the probe.
+		match &= (empty & -empty) - 1;
+
+		for (; match != 0; match &= match - 1) {
+			const u32 slot = i + __builtin_ctz(match) / 2;
+
+			likelyp_if (table->keys[slot].matx == mat.matx, 0.999)
+				return table->vals[slot];
+		}
+
+		likelyp_if (empty != 0, 0.9) {
+			const u32 slot = i + __builtin_ctz(empty) / 2;
+
+			unlikelyp_if (table->len == TRANSIENT_LEN, 0.9999999)
+				return TABLE_FULL;
+
+			table->keys[slot] = mat;
+			table->vals[slot] = val;
+			table->tags[slot] = tag;
+			table->len++;
+
+			unlikelyp_if (slot != h, 0.8) {
+			#if DEBUG
+				total_collisions++;
+			#endif
+				table->collisions++;
+
+				unlikely_if (slot >= TABLE_LEN && slot - TABLE_LEN >= table->tail)
+					table->tail = slot - TABLE_LEN + 1;
+			}
+
+			return TABLE_NO_VALUE;
+		}
 	}
-	else {
-		// handle collision
+}
+
+static FORCE_INLINE void HashTable_clear(HashTable *const restrict table) {
+	table->len        = 0;
+	table->collisions = 0;
+	table->tail       = 0;
+
+	unlikelyp_if (++table->gen == 0, 0.996) {
+		// the old generations could match the new ones now.
+		memset(table->tags, 0, sizeof table->tags);
+		table->gen = 1;
+	}
+}
+
+static struct {
+	Matx8 *keys;
+	u32 *vals;  // TABLE_NO_VALUE is an empty slot
+	u32 bits;   // log2 of the number of slots. 0 when it isn't allocated
+	u32 len;    // number of states in it
+} spill = {0};
 
-	#if DEBUG
-		total_collisions++;
-	#endif
+static void _spill_resize(const u32 bits) {
+	// moves everything to a new table with 2^bits slots.
+	Matx8 *const keys = malloc(sizeof(Matx8) << bits);
+	u32 *const vals   = malloc(sizeof(u32) << bits);
+	OOM(keys, 13);
+	OOM(vals, 13);
 
-		if (hashtable.arena_pos == ARENA_MAX)
-			return true; // out of arena memory
+	memset(vals, 0xff, sizeof(u32) << bits);
 
-		const u32 entry_id = hashtable.arena_pos++;
+	for (u32 i = 0; spill.bits != 0 && i < 1u << spill.bits; i++) {
+		if (spill.vals[i] == TABLE_NO_VALUE)
+			continue;
 
-		// NOTE: if there is a collision, the `next` field will never be ARENA_NO_BUCKET,
-		//       so don't worry about trying to normalize the `next` field.
+		u32 slot = spill.keys[i].matx * 0x9e3779b97f4a7c15llu >> (64 - bits);
 
-		// don't traverse the linked list. just put the new entry at in the second spot.
-		hashtable.overflow_arena[entry_id] = (TableEntry) {
-			.key  = mat,
-			.next = hashtable.buckets[h].next,
-			.val  = val
-		};
+		while (vals[slot] != TABLE_NO_VALUE)
+			slot = (slot + 1) & ((1u << bits) - 1);
 
-		hashtable.buckets[h].next = entry_id;
+		keys[slot] = spill.keys[i];
+		vals[slot] = spill.vals[i];
 	}
 
-	return false;
-}
+	free(spill.keys);
+	free(spill.vals);
 
-static FORCE_INLINE bool Table__add2(const Matx8 mat, const u32 val) {
-	return Table__add3(mat, val, Matx8_hash(mat));
+	spill.keys = keys;
+	spill.vals = vals;
+	spill.bits = bits;
 }
 
-static u32 Table__get2(const Matx8 mat, u32 h) {
-	TableEntry *entry = hashtable.buckets + h;
+static u32 _spill_get_add(const Matx8 mat, const u32 val) {
+	// the same as HashTable_get_add, for the states that didn't fit in the fixed table.
+	// returns TABLE_FULL once the trial has STEP_MAX states.
+	unlikely_if (spill.bits == 0 || 2*(spill.len + 1) > 1u << spill.bits) {
+		unlikely_if (TRANSIENT_LEN + spill.len >= STEP_MAX)
+			return TABLE_FULL;
 
-	if (entry->next == ARENA_NO_BUCKET)
-		// bucket is empty. no value to retrieve.
-		return TABLE_NO_VALUE;
+		_spill_resize(spill.bits == 0 ? 33 - __builtin_clz(TRANSIENT_LEN) : spill.bits + 1);
+	}
 
-	while (true) {
-		if (entry->key.matx == mat.matx)
-			return entry->val;
+	const u32 mask = (1u << spill.bits) - 1;
 
-		if (entry->next == ARENA_NO_NEXT)
-			break;
+	for (u32 slot = mat.matx * 0x9e3779b97f4a7c15llu >> (64 - spill.bits);; slot = (slot + 1) & mask) {
+		unlikely_if (spill.vals[slot] == TABLE_NO_VALUE) {
+			spill.keys[slot] = mat;
+			spill.vals[slot] = val;
+			spill.len++;
+			return TABLE_NO_VALUE;
+		}
 
-		entry = hashtable.overflow_arena + entry->next;
+		unlikely_if (spill.keys[slot].matx == mat.matx)
+			return spill.vals[slot];
 	}
-
-	return TABLE_NO_VALUE;
 }
 
-static FORCE_INLINE u32 Table__get1(const Matx8 mat) {
-	return Table__get2(mat, Matx8_hash(mat));
+static void _spill_free(void) {
+	free(spill.keys);
+	free(spill.vals);
+	spill = (typeof(spill)) {0};
 }
 
-/////////////////////////// public API methods //////////////////////////
+// the Table_* functions all operate on the global table.
+
+static FORCE_INLINE u32 Table__get_add3(const Matx8 mat, const u32 val, const u32 h) {
+	// the fixed table still has the first TRANSIENT_LEN states once it is full, so only the
+	// ones it doesn't have are looked up in the spill table.
+	const u32 table_value = HashTable_get_add(&hashtable, mat, val, h);
+
+	unlikelyp_if (table_value == TABLE_FULL, 0.9999999)
+		return _spill_get_add(mat, val);
 
-// NOTE: returns false if it succeeded, and true if it ran out of arena memory.
-#define Table_add(mat, val, h...) \
-	VA_IF(Table__add3(mat, val, (h)), Table__add2(mat, val), h)
+	return table_value;
+}
+
+static FORCE_INLINE u32 Table__get_add2(const Matx8 mat, const u32 val) {
+	return Table__get_add3(mat, val, Matx8_hash(mat));
+}
 
-// NOTE: it returns TABLE_NO_VALUE (~0u) if the entry doesn't exist.
-//       a real value should not get that high, so it is fine.
-#define Table_get(mat, h...) \
-	VA_IF(Table__get2(mat, (h)), Table__get1(mat), h)
+/////////////////////////// public API methods //////////////////////////
 
-static void Table_clear(void) {
-	_Static_assert((TABLE_LEN & 3) == 0, "TABLE_LEN must be a multiple of 4");
+// NOTE: returns the value if `mat` was already in the table, and otherwise adds it and
+//       returns TABLE_NO_VALUE (~0u), or TABLE_FULL if there are already STEP_MAX states.
+#define Table_get_add(mat, val, h...) \
+	VA_IF(Table__get_add3(mat, val, (h)), Table__get_add2(mat, val), h)
 
-	hashtable.arena_pos = 0;
+static FORCE_INLINE void Table_clear(void) {
+	HashTable_clear(&hashtable);
 
-	for (u32 i = 0; i < TABLE_LEN; i += 4) {
-		// only touch one cache line per iteration.
-		hashtable.buckets[i | 0].next = ARENA_NO_BUCKET;
-		hashtable.buckets[i | 1].next = ARENA_NO_BUCKET;
-		hashtable.buckets[i | 2].next = ARENA_NO_BUCKET;
-		hashtable.buckets[i | 3].next = ARENA_NO_BUCKET;
+	// a long trial is done, so give the memory back.
+	unlikelyp_if (spill.bits != 0, 0.9999999)
+		_spill_free();
+}
 
-		// NOTE: the other fields don't need to be cleared because they won't
-		//       be read again until after the next time they are set.
-	}
+static void Table_reset(void) {
+	// for after `scratch` was used: HashTable_clear only changes the generation, so whatever
+	// was written over the tags (and `gen`) would look like slots that are in use.
+	memset(hashtable.tags, 0, sizeof hashtable.tags);
+	hashtable.gen = 0;
+	Table_clear();
 }
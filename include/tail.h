@@ -0,0 +1,223 @@
+#pragma once
+#define TAIL_H
+
+// `tail K [N]`: estimates P(transient > K) with subset simulation, for K that are too rare
+// for `nrun`. requires cycle.h. the transient is the index of the first repeat, like the
+// histograms.
+
+// a trial is a deterministic function of its start state, so the only thing to split on is
+// the start state. a level starts with N random start states. the TAIL_P0 fraction of them
+// with the longest transients set the next level, and each of those starts a Markov chain
+// that flips some random bits of its state and only moves there if the new state is still
+// past the level. the proposal is symmetric and the start states are uniform, so the chains
+// sample the start states past the level uniformly, and the next level is set from them the
+// same way. the number of bits starts at 1, and goes up after a level where more than
+// TAIL_ACCEPT of the moves were taken and down after one where less than half that were, so
+// the chains take bigger steps where the set is big enough for them. once a level is past K,
+// P(transient > K) is the product of the fraction that made it past each level, and the
+// fraction of the last one that is past K.
+
+// so each level is only N trials, and there are about log(1/P) / log(1/TAIL_P0) of them,
+// where `nrun` would need about 1/P trials for each hit. the chains are correlated, so the
+// error is from TAIL_REPS separate runs of the whole thing, and the estimate is their mean.
+// the levels are picked as it goes, which is biased by about 1/N, much less than the error.
+// the interval uses the t distribution with TAIL_REPS - 1 degrees of freedom, since the
+// standard deviation is from so few runs.
+
+// that only helps if a state past a level is more likely than a random one to have a
+// neighbor past it too. for B3/S23 on 8x8, it isn't past a transient of about 100: one flip
+// anywhere changes the whole trajectory, and past 200, 5% of the flips keep the same
+// transient (the flip dies right away) and 0.05% give a different one past the level,
+// which is the same as a random state. so the chains only move between copies of the same
+// few trajectories, the runs disagree a lot, and some of them end with every sample on one
+// transient and give 0. it counts the moves that changed the transient, and says so when
+// they were no more likely to be past the level than a random state, since `nrun` is at
+// least as good then. other rulesets (`-r`) can have tails that the chains do mix in.
+
+#define TAIL_P0		0.1   // the fraction of each level that the next one starts from
+#define TAIL_ACCEPT	0.25  // the fraction of the moves that makes the chains flip another bit
+#define TAIL_FLIPS	8     // the most bits each step of a chain flips
+#define TAIL_REPS	8     // separate estimates, for the error
+#define TAIL_LEVELS	256   // levels before it gives up
+
+// the 97.5% quantile of t with TAIL_REPS - 1 = 7 degrees of freedom, for the interval.
+#define TAIL_T		2.364624251592785
+
+_Static_assert(TAIL_REPS == 8, "TAIL_T is for 7 degrees of freedom");
+
+typedef struct {
+	Matx8 state;
+	u32 transient;
+} TailSample;
+
+static u64 tail_trials = 0; // total trials, for comparing to `nrun`
+static u32 tail_stuck  = 0; // the lowest level where the chains mixed no better than random states
+
+static u32 _tail_transient(const Matx8 start_state) {
+	// the index of the first repeat, without recording anything. trials that are too long
+	// count as STEP_MAX, which is past every level.
+	Board state = start_state;
+
+	tail_trials++;
+	Cycle_clear(start_state, CYCLE_TABLE);
+
+	for (u32 step = 0;; step++) {
+		const u8 status = Cycle_add(state, step, CYCLE_TABLE);
+
+		likelyp_if (status == CYCLE_NONE, 0.92129) {
+			state = Board_next(state);
+			continue;
+		}
+
+		return status == CYCLE_FOUND ? step : STEP_MAX;
+	}
+}
+
+static i32 _tail_cmp(const void *const a, const void *const b) {
+	// longest transient first.
+	const u32 x = ((const TailSample *) a)->transient, y = ((const TailSample *) b)->transient;
+	return (x < y) - (x > y);
+}
+
+static u32 _tail_level(TailSample *const restrict samples, const u32 n, const u32 last) {
+	// sorts the samples, and returns the level for the next ones. it is the transient of the
+	// sample at TAIL_P0, unless the ones before it all have the same transient as it, in which
+	// case it is one less, so at least one of them is past it. it is always past `last`, the
+	// level these came from, so a level where they all have the same transient still ends.
+	qsort(samples, n, sizeof(TailSample), &_tail_cmp);
+
+	u32 level = samples[(u32) (n * TAIL_P0)].transient;
+
+	if (samples[0].transient == level)
+		level--;
+
+	return level > last ? level : last + 1;
+}
+
+static u32 _tail_count(const TailSample *const restrict samples, const u32 n, const u32 level) {
+	// the number of samples past `level`. they are sorted, so it is where they stop being.
+	u32 count = 0;
+
+	while (count < n && samples[count].transient > level)
+		count++;
+
+	return count;
+}
+
+static double _tail_once(const u32 k, const u32 n, TailSample *const restrict samples, const bool verbose) {
+	// one subset simulation estimate of P(transient > k).
+	double p = 1.0;
+	u8 flips = 1;
+
+	for (u32 i = 0; i < n; i++) {
+		const Matx8 state = Matx8_random();
+		samples[i] = (TailSample) {.state = state, .transient = _tail_transient(state)};
+	}
+
+	// every transient is at least 1, so everything is past level 0.
+	for (u32 depth = 0, level = 0; depth < TAIL_LEVELS; depth++) {
+		level = _tail_level(samples, n, level);
+		const u32 shown = level < k ? level : k;
+		const u32 seeds = _tail_count(samples, n, shown);
+
+		likely_if (verbose)
+			printf("    level %u: transient > %u, %.4g of the samples\n", depth, shown, (double) seeds / n);
+
+		// if none of them are past it, the chains have all ended up on the same transient,
+		// and there is nowhere left to go, so it is 0 for this run.
+		unlikely_if (level >= k || seeds == 0)
+			return p * seeds / n;
+
+		p *= (double) seeds / n;
+
+		// moves taken, and the ones of those that went to a different transient.
+		u32 moved = 0, fresh = 0;
+
+		// the seeds are at the start, and each one's chain writes over the samples after them.
+		// the chains are written from the back, so none of them overwrite a seed that hasn't
+		// started yet. every seed gets n / seeds samples, and the first ones get the rest.
+		for (u32 s = seeds; s --> 0 ;) {
+			const u32 extra = n % seeds;
+			const u32 len   = n / seeds + (s < extra);
+			const u32 first = s * (n / seeds) + (s < extra ? s : extra);
+			TailSample current = samples[s];
+
+			for (u32 j = 0; j < len; j++) {
+				samples[first + j] = current;
+
+				Matx8 proposal = current.state;
+
+				for (u8 f = 0; f < flips; f++)
+					proposal.matx ^= 1llu << (Matx8_random().matx & 63);
+
+				const u32 transient = _tail_transient(proposal);
+
+				if (transient > level && proposal.matx != current.state.matx) {
+					moved++;
+					fresh  += transient != current.transient;
+					current = (TailSample) {.state = proposal, .transient = transient};
+				}
+			}
+		}
+
+		likely_if (verbose)
+			printf("    %u bit flips, %.4g of them moved, %.4g to a new transient\n",
+				flips, (double) moved / n, (double) fresh / n);
+
+		// `p` is about the fraction of random states past the level.
+		unlikely_if ((double) fresh / n <= p && (tail_stuck == 0 || level < tail_stuck))
+			tail_stuck = level;
+
+		if ((double) moved / n > TAIL_ACCEPT && flips < TAIL_FLIPS)
+			flips++;
+		else if ((double) moved / n < TAIL_ACCEPT / 2 && flips > 1)
+			flips--;
+	}
+
+	// more than TAIL_LEVELS levels, which is at least TAIL_P0^TAIL_LEVELS.
+	return 0.0;
+}
+
+static void tail_run(const u32 k, const u32 n) {
+	// prints P(transient > k), with the 95% interval from TAIL_REPS estimates.
+	TailSample *const samples = malloc(n * sizeof(TailSample));
+	OOM(samples, 17);
+
+	const bool verbose = !cfg.quiet;
+	double sum = 0.0, sum2 = 0.0;
+
+	for (u32 rep = 0; rep < TAIL_REPS; rep++) {
+		likely_if (verbose)
+			printf("run %u:\n", rep + 1);
+
+		const double p = _tail_once(k, n, samples, verbose);
+		sum  += p;
+		sum2 += p * p;
+
+		likely_if (verbose)
+			printf("    P(transient > %u) = %.6g\n", k, p);
+	}
+
+	free(samples);
+
+	const double mean = sum / TAIL_REPS;
+	const double var  = (sum2 - sum * mean) / (TAIL_REPS - 1);
+	const double se   = __builtin_sqrt((var > 0 ? var : 0) / TAIL_REPS);
+
+	likely_if (!cfg.silent) {
+		if (cfg.quiet)
+			printf("%.6g %.6g %zu\n", mean, se, tail_trials);
+		else {
+			printf("P(transient > %u) = %.6g +- %.3g (95%%, %u runs), in %zu trials\n",
+				k, mean, TAIL_T * se, TAIL_REPS, tail_trials);
+
+			// the trials `nrun` needs for the same standard error, (1 - p) p / se^2.
+			if (se > 0)
+				printf("nrun would need about %.3g trials for the same error\n", (1 - mean) * mean / (se * se));
+
+			if (tail_stuck != 0)
+				printf("past transient %u, the chains didn't find new transients any more often than random"
+					" states do, so `nrun` is about as good\n", tail_stuck);
+		}
+	}
+}
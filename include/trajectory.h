@@ -0,0 +1,118 @@
+#pragma once
+#define TRAJECTORY_H
+
+// defines Trajectory_write, for the `-t` flag. requires cycle.h.
+
+// when a trial is logged, its whole trajectory is usually still in the table it ran with:
+// the 8x8 tables have every state as a key with its step index as the value, and the
+// others have them in board_path. so for the logged trials, this puts them back in order
+// and appends them to TRAJFILE, without simulating them again. the trials that stopped
+// early (attractor cache, memo) only step the part after where they stopped, and the ones
+// without a table (Brent, Nivasch) step all of it. nothing happens for the trials that
+// aren't logged, so it is free unless something interesting shows up.
+
+// each trial is one line: the trial number (the same one as the log), the transient, the
+// period, and then every state from the start state up to the last one before the first
+// repeat, in the same hex as the log, separated by spaces.
+
+static u32 _trajectory_known(const HashTable *const restrict table) {
+	// how many states at the start of the trajectory are in `table`. the states are added
+	// one step at a time, so it is always the first ones. the spill table (table.h) only
+	// has states for the global table.
+	likely_if (table == NULL)
+		return 0;
+
+	return table->len + (table == &hashtable ? spill.len : 0);
+}
+
+static void Trajectory_write(
+	const Board start_state,
+	const u32 step,
+	const u32 period,
+	const HashTable *const restrict table,
+	const u64 trial
+) {
+	// `step` is the index of the first repeat, so it writes states 0 to `step - 1`.
+	// `table` is the one the trial ran with, or NULL if it didn't use one.
+	u32 known = _trajectory_known(table);
+
+	if (known > step)
+		known = step;
+
+	char *const line = malloc(64 + (u64) step * BOARD_STR_LEN);
+	OOM(line, 14);
+
+	char *p = line + sprintf(line, "%zu %u %u", trial, step - period, period);
+	Board state = start_state;
+
+#if BOARD_SIZE == 8
+	if (known != 0 && (CYCLE_DETECT != CYCLE_SYMMETRY || table != &hashtable)) {
+		// the keys are the states, so they go back in order by their values.
+		Matx8 *const path = malloc(known * sizeof(Matx8));
+		OOM(path, 14);
+
+		for (u32 slot = 0; slot < TABLE_LEN + table->tail; slot++)
+			if (table->tags[slot] >> 8 == table->gen && table->vals[slot] < known)
+				path[table->vals[slot]] = table->keys[slot];
+
+		for (u32 slot = 0; table == &hashtable && slot < (spill.bits ? 1u << spill.bits : 0); slot++)
+			if (spill.vals[slot] < known)
+				path[spill.vals[slot]] = spill.keys[slot];
+
+		for (u32 i = 0; i < known; i++) {
+			*p++ = ' ';
+			p = Board_sprint(p, path[i]);
+		}
+
+		state = path[known - 1];
+		free(path);
+	}
+	else
+#endif
+	{
+		for (u32 i = 0; i < known; i++) {
+			*p++ = ' ';
+			p = Board_sprint(p, Cycle_path_get(i));
+		}
+
+		if (known != 0)
+			state = Cycle_path_get(known - 1);
+	}
+
+	// the part the table doesn't have.
+	for (u32 i = known; i < step; i++) {
+		if (i != 0)
+			state = Board_next(state);
+
+		*p++ = ' ';
+		p = Board_sprint(p, state);
+	}
+
+	*p++ = '\n';
+
+	const i32 fd = _open(TRAJFILE, O_CREAT | O_WRONLY | O_BINARY, S_IWRITE);
+
+	unlikely_if (fd == -1) {
+		i32 error; _get_errno(&error);
+		eprintf("can't %s %s: errno=%u.\n", "open", TRAJFILE, error);
+		exit(EXIT_DATAFILE);
+	}
+
+	// other processes could be writing to it too, so the seek is after the lock, like DATAFILE.
+	while (_locking(fd, LK_NBLCK, INT32_MAX) != 0) {
+		i32 error; _get_errno(&error);
+
+		if (error != 13 /* EACCES */) {
+			eprintf("can't %s %s: errno=%u.\n", "lock", TRAJFILE, error);
+			exit(EXIT_DATAFILE);
+		}
+
+		Sleep(333);
+	}
+
+	_lseeki64(fd, 0, SEEK_END);
+	_write(fd, line, p - line);
+	_close(fd);
+
+	free(line);
+}
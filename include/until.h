@@ -0,0 +1,171 @@
+#pragma once
+#define UNTIL_H
+
+// defines `nrun until`. requires run.h.
+
+// `nrun until E [X...]` runs trials until the confidence interval of every X is within a
+// relative E of its estimate, e.g. `nrun until 0.01 p132` stops once P(period=132) is known
+// to 1%. the intervals are at UNTIL_Z (95% by default), like analyze.py, but Agresti-Coull
+// instead of the plain normal approximation, so a count of 0 or of every trial doesn't look
+// exact after one batch. it is checked after every UNTIL_BATCH trials, which is nothing next
+// to running them. the stop key still works, and gives the summary for what it has.
+
+// a statistic that never happens (or a target that is too small) would keep it going forever,
+// so it also stops after UNTIL_MAX trials. with `-f`, it saves the summary and starts a new one
+// every TIMER_PERIOD like `nrun inf`, and the intervals are for all of the trials since it
+// started, not just the ones in the current summary.
+
+// X can be:
+//     empty, const, cycle   the fraction of the trials that end that way
+//     pN                    the fraction with a period of N
+//     tN                    the fraction with a transient of N (the first repeat, like the histograms)
+// the default is all three counts.
+
+// how often it checks, and how often it checks the stop key.
+#define UNTIL_BATCH (UINT8_MAX * 32)
+
+// how many trials at a time it takes from PERMFILE with `-p`.
+#define UNTIL_CLAIM (1llu << 24)
+
+#define UNTIL_COUNT		0
+#define UNTIL_PERIOD	1
+#define UNTIL_TRANSIENT	2
+
+typedef struct {
+	u64 saved; // the count from the summaries that were already saved
+	u32 value; // the sttyp_t, the period, or the transient
+	u8 kind;   // UNTIL_COUNT, UNTIL_PERIOD, or UNTIL_TRANSIENT
+} UntilStat;
+
+static u64 until_saved = 0; // trials in the summaries that were already saved
+
+static bool Until_parse(UntilStat *const restrict stat, const char *const restrict str) {
+	// returns false if `str` isn't one of the things above.
+	if (streq(str, "empty")) { *stat = (UntilStat) {.kind = UNTIL_COUNT, .value = EMPTY}; return true; }
+	if (streq(str, "const")) { *stat = (UntilStat) {.kind = UNTIL_COUNT, .value = CONST}; return true; }
+	if (streq(str, "cycle")) { *stat = (UntilStat) {.kind = UNTIL_COUNT, .value = CYCLE}; return true; }
+
+	unlikely_if ((str[0] != 'p' && str[0] != 't') || str[1] < '0' || str[1] > '9')
+		return false;
+
+	char *end;
+	const u64 value = strtoull(str + 1, &end, 10);
+
+	unlikely_if (*end != '\0' || value > STEP_MAX)
+		return false;
+
+	*stat = (UntilStat) {.kind = str[0] == 'p' ? UNTIL_PERIOD : UNTIL_TRANSIENT, .value = value};
+	return true;
+}
+
+static u64 _until_count(const UntilStat stat) {
+	switch (stat.kind) {
+	case UNTIL_COUNT:
+		return data.counts[stat.value];
+	case UNTIL_PERIOD:
+		return stat.value <= PERIOD_MAX ? data.periods[stat.value] : LongHist_get(&long_periods, stat.value);
+	case UNTIL_TRANSIENT:
+		return stat.value <= TRANSIENT_MAX ? data.transients[stat.value] : LongHist_get(&long_transients, stat.value);
+	default: __builtin_unreachable();
+	}
+}
+
+static FORCE_INLINE u64 _until_trials(void) {
+	return until_saved + data.counts[EMPTY] + data.counts[CONST] + data.counts[CYCLE];
+}
+
+static double _until_precision(const UntilStat stat, double *const restrict estimate) {
+	// the half width of the interval over the estimate, which it also sets `estimate` to.
+	const double n = _until_trials();
+	const double z2 = UNTIL_Z * UNTIL_Z;
+
+	// Agresti-Coull: 2 successes and 2 failures are added at 95%.
+	const double p = (stat.saved + _until_count(stat) + z2/2) / (n + z2);
+	*estimate = p;
+
+	return UNTIL_Z * __builtin_sqrt(p * (1 - p) / (n + z2)) / p;
+}
+
+static void _until_print(const UntilStat *const restrict stats, const u32 len) {
+	printf("\n");
+
+	for (u32 i = 0; i < len; i++) {
+		double p;
+		const double rel = _until_precision(stats[i], &p);
+
+		switch (stats[i].kind) {
+		case UNTIL_COUNT:     printf("%s", stats[i].value == EMPTY ? "empty" : stats[i].value == CONST ? "const" : "cycle"); break;
+		case UNTIL_PERIOD:    printf("p%u", stats[i].value); break;
+		case UNTIL_TRANSIENT: printf("t%u", stats[i].value); break;
+		}
+
+		printf(": %.6g%% +- %.3g%% (%.3g%% of it)\n", p * 100, p * rel * 100, rel * 100);
+	}
+}
+
+static void _until_save(UntilStat *const restrict stats, const u32 len) {
+	// saves the summary, and keeps what was in it for the intervals.
+	until_saved = _until_trials();
+
+	for (u32 i = 0; i < len; i++)
+		stats[i].saved += _until_count(stats[i]);
+
+	run_save();
+	enputs("More than " TOSTRING_EXPANDED(TIMER_PERIOD)
+		" seconds have passed since the last summary. saved it and started a new one.");
+}
+
+static void run_until(const double target, UntilStat *const restrict stats, const u32 len) {
+	// runs batches until every one of `stats` is within `target`, the stop key is pressed, or
+	// it has run UNTIL_MAX trials.
+	u64 last_save = (u64) _time64(NULL);
+#if COUNTER_RAND
+	u64 claimed = 0; // trials that are left from the last `-p` claim
+#endif
+
+	while (true) {
+	#if COUNTER_RAND
+		unlikely_if (claims.permute && claimed < UNTIL_BATCH) {
+			Claim_next(UNTIL_CLAIM);
+			claimed = UNTIL_CLAIM;
+		}
+
+		claimed -= UNTIL_BATCH;
+	#endif
+
+		for (u8 i = 0; i < UINT8_MAX; i++)
+			RUN_32();
+
+		unlikelyp_if (keypressed(cfg.keys.stop), 0.9999)
+			break;
+
+		bool done = true;
+
+		for (u32 i = 0; i < len && done; i++) {
+			double p;
+			done = _until_precision(stats[i], &p) <= target;
+		}
+
+		unlikely_if (done)
+			break;
+
+	#if UNTIL_MAX != 0
+		unlikely_if (_until_trials() >= UNTIL_MAX) {
+			likely_if (!cfg.silent)
+				enputs("ran UNTIL_MAX (" TOSTRING_EXPANDED(UNTIL_MAX) ") trials without getting there. stopping.");
+
+			break;
+		}
+	#endif
+
+		// the same timer as `nrun inf`, but it can check it every batch, because this is
+		// already checking the precision every batch.
+		unlikely_if (cfg.file_out && (u64) _time64(NULL) >= last_save + TIMER_PERIOD) {
+			last_save = (u64) _time64(NULL);
+			_until_save(stats, len);
+		}
+	}
+
+	likely_if (!cfg.quiet)
+		_until_print(stats, len);
+}
@@ -42,11 +42,20 @@ u32 WaitForSingleObject(void *handle, u32 ms);
 void *GetCurrentProcess(void);
 bool SetPriorityClass(void *process, u32 priorityClass);
 bool SetProcessAffinityMask(void *process, u64 processAffinityMask);
+bool QueryPerformanceCounter(i64 *count);
+bool QueryPerformanceFrequency(i64 *frequency);
+void *CreateThread(void *attrs, u64 stackSize, u32 (*start)(void *param), void *param, u32 flags, u32 *threadId);
+u32 WaitForMultipleObjects(u32 count, void *const *handles, bool waitAll, u32 ms);
+bool CloseHandle(void *handle);
+u32 GetActiveProcessorCount(u16 group);
 
 #define ERROR_ALREADY_EXISTS    183
 #define GMEM_MOVEABLE           0x02
 #define HIGH_PRIORITY_CLASS     0x80
 #define REALTIME_PRIORITY_CLASS 0x100
+#define WAIT_TIMEOUT            258
+#define MAXIMUM_WAIT_OBJECTS    64
+#define ALL_PROCESSOR_GROUPS    0xFFFF
 
 // define the real names for the stupid functions
 #define WaitForMutexUnlock WaitForSingleObject
@@ -4,14 +4,8 @@
 // for unions. C just reinterprets the bits as the other type with no change,
 // even if the standard doesn't technically guarantee that is what happens.
 
-// TODO: put the ruleset somewhere in the data.json file.
-//       in the python file, only collapse objects with the same ruleset
-//       or maybe include the ruleset in the filename?
 // TODO: consider making a second version of life-launch for predecessor trial testing.
 // TODO: consider letting the user pass more than one input state to `bwsr`
-// TODO: consider adding a flag to make it so a cell counts as its own neighborhood
-// TODO: given a list of states A1, A2, ..., AN, determine if there is a ruleset
-//       under which state A1 => A2, A2 => A3, etc.
 // TODO: idk, maybe figure out if GPU acceleration can work somewhere for this?
 
 ///////////////////////////////// config start ////////////////////////////////
@@ -38,25 +32,100 @@
 	#define TIMER_PERIOD	43200 // seconds
 #endif
 
+// the z score of the confidence intervals for `nrun until`. 1.96 is 95%.
+#ifndef UNTIL_Z
+	#define UNTIL_Z		1.959963984540054
+#endif
+
+// the most trials `nrun until` runs before it gives up and gives the summary anyway, for a
+// statistic that never shows up, which never gets below a relative error of about 1.41.
+// 2^36 is about half a day on my machine. 0 is no limit.
+#ifndef UNTIL_MAX
+	#define UNTIL_MAX	68719476736
+#endif
+
 // step value threshold after which `life step` will start using modulo on the count
 // 512-1024 is around the ballpark of when it starts giving improvement
 #ifndef STEP_MOD_THRESH
 	#define STEP_MOD_THRESH	512
 #endif
 
+// side length of the torus for the run commands. 8 is Matx8, which is by far the
+// fastest. 16 and 32 are for seeing how the statistics scale (see board.h).
+#ifndef BOARD_SIZE
+	#define BOARD_SIZE		8
+#endif
+
 // NOTE: these values and comments are for NEIGHBORHOOD=MOORE and RULESET=B3/S23
 //       other ones may need way more memory for stuff like the transients
 //       for example, VON_NEUMANN with B23/S23 needs TRANSIENT_LEN >= 2048
+//       the defaults for the bigger boards are given separately after these.
+
+#if BOARD_SIZE == 16
+	// the longest transient in 200,000 B3/S23 trials was 1336, and the longest period was 64.
+	#ifndef TABLE_BITS
+		#define TABLE_BITS		12
+	#endif
+	#ifndef TABLE_BITS_MAX
+		#define TABLE_BITS_MAX	14
+	#endif
+	#ifndef PERIOD_LEN
+		#define PERIOD_LEN		256
+	#endif
+	#ifndef TRANSIENT_LEN
+		#define TRANSIENT_LEN	4096
+	#endif
+	// about as rare as the 8x8 ones, and past the period 64 of a glider.
+	#ifndef LOG_TRANSIENT
+		#define LOG_TRANSIENT	880
+	#endif
+	#ifndef LOG_PERIOD
+		#define LOG_PERIOD		72
+	#endif
+#elif BOARD_SIZE == 32
+	// the longest transient in 5,000 B3/S23 trials was 3490, and the longest period was 128.
+	#ifndef TABLE_BITS
+		#define TABLE_BITS		14
+	#endif
+	#ifndef TABLE_BITS_MAX
+		#define TABLE_BITS_MAX	16
+	#endif
+	#ifndef PERIOD_LEN
+		#define PERIOD_LEN		512
+	#endif
+	#ifndef TRANSIENT_LEN
+		#define TRANSIENT_LEN	16384
+	#endif
+	// about as rare as the 8x8 ones, and past the period 128 of a glider.
+	#ifndef LOG_TRANSIENT
+		#define LOG_TRANSIENT	3500
+	#endif
+	#ifndef LOG_PERIOD
+		#define LOG_PERIOD		144
+	#endif
+#endif
 
 // use 8 for hyperthreading. 9  the fastest on a single core.
 // unless your L1 cache is 64KiB, in which case 9 or maybe even 10 is probably better.
-// this has to be at least 2, or the program will not work.
+// this has to be at least 2, or the program will not work. it is only the default, and
+// `--calibrate` can pick anything from 2 to TABLE_BITS_MAX for the machine it runs on.
 #ifndef TABLE_BITS
 	#define TABLE_BITS		9
 #endif
 
+// the tables are allocated for this many bits, so it is the most `--calibrate` can pick.
+#ifndef TABLE_BITS_MAX
+	#define TABLE_BITS_MAX	11
+#endif
+
+#if TABLE_BITS > TABLE_BITS_MAX
+	#undef TABLE_BITS_MAX
+	#define TABLE_BITS_MAX	TABLE_BITS
+#endif
+
 // 512 makes them one page of memory.
-// these have to be at least 133 and 424 respectively.
+// the longest period and transient in B3/S23 are 132 and 423. the longer ones still work,
+// but they go in the long histograms and the spill table (table.h), which are much slower.
 #ifndef PERIOD_LEN
 	#define PERIOD_LEN		136
 #endif
@@ -64,14 +133,37 @@
 	#define TRANSIENT_LEN	448
 #endif
 
+// a trial with a longer transient and a longer period than these is logged (run.h). the
+// transient one is past about 1 in 5,000 trials for each board size.
+#ifndef LOG_TRANSIENT
+	#define LOG_TRANSIENT	196
+#endif
+#ifndef LOG_PERIOD
+	#define LOG_PERIOD		36
+#endif
+
+// the most steps a trial can take before it is given up on. the spill table can grow to
+// 2 slots for each of them, which is 24 bytes a step for 8x8, and more for the bigger boards.
+#ifndef STEP_MAX
+	#define STEP_MAX		4194304
+#endif
+
+// 1 uses RDRAND instead of a buffer. otherwise, it is the default buffer length, and
+// `--calibrate` can pick any power of 2 up to 256.
 #ifndef RAND_BUF_LEN
 	#define RAND_BUF_LEN	128
 #endif
 
-// max number of collisions per trial before errors.
-// this has to be at least 143 with TABLE_BITS=9
-#ifndef ARENA_LEN
-	#define ARENA_LEN		256
+#ifndef COUNTER_RAND
+	// true  => the random states come from a counter-based generator, seeded with `-g`, or
+	//          from RtlGenRandom once at startup. RAND_BUF_LEN doesn't do anything.
+	// false => RtlGenRandom or RDRAND, depending on RAND_BUF_LEN, and there is no `-g`.
+	#define COUNTER_RAND true
+#endif
+
+#ifndef CALIBFILE
+	// where `--calibrate` saves the sizes it picked, and where every run loads them from.
+	#define CALIBFILE "calibrate.txt"
 #endif
 
 #ifndef PY_BASE
@@ -83,6 +175,16 @@
 	#define DATAFILE "data.json"
 #endif
 
+#ifndef PERMFILE
+	// where `-p` keeps the next trial of each seed that hasn't been taken yet
+	#define PERMFILE "permutation.txt"
+#endif
+
+#ifndef TRAJFILE
+	// where `-t` writes the trajectories of the logged trials
+	#define TRAJFILE "trajectories.txt"
+#endif
+
 #ifndef CLIPBOARD
 	// true  => include the -c flag
 	// false => no -c flag (less DLL imports)
@@ -101,6 +203,116 @@
 	#define BWSEARCH true
 #endif
 
+#ifndef SWEEP
+	// true  => include the swep command
+	// false => don't.
+	#define SWEEP true
+#endif
+
+#ifndef CENSUS
+	// true  => include the cens command
+	// false => don't.
+	#define CENSUS true
+#endif
+
+#ifndef TAIL
+	// true  => include the tail command
+	// false => don't. it only beats nrun when the chains mix, which they don't for B3/S23.
+	#define TAIL false
+#endif
+
+#ifndef STRAT
+	// true  => include `nrun strat`
+	// false => don't.
+	#define STRAT true
+#endif
+
+#ifndef TAIL_N
+	// the default number of start states for each level of `tail`.
+	#define TAIL_N 10000
+#endif
+
+#ifndef SIMD_RUN
+	// true  => nrun steps several trials at once with the multi-board engine (run-simd.h)
+	// false => nrun runs one trial at a time.
+	// the lane count comes from the ISA, so only default to it when there are more than 2.
+	// the bigger boards already fill the vector registers by themselves.
+	#if defined(__AVX2__) && BOARD_SIZE == 8
+		#define SIMD_RUN true
+	#else
+		#define SIMD_RUN false
+	#endif
+#endif
+
+#ifndef INTERLEAVE_RUN
+	// true  => without SIMD_RUN, include the engine that keeps several trials going at once in
+	//          a single thread, and goes around them one step at a time (run-interleave.h).
+	//          how many is the batch width, which `--calibrate` picks, and 1 is `run_once`.
+	// false => nrun always runs one trial at a time.
+	#define INTERLEAVE_RUN true
+#endif
+
+// the most trials the interleaved engine can keep going at once. each one has its own table.
+#ifndef INTERLEAVE_K
+	#define INTERLEAVE_K	8
+#endif
+
+// the batch width without a calibration file. 1 is `run_once`, which was faster on my machine.
+#ifndef INTERLEAVE_WIDTH
+	#define INTERLEAVE_WIDTH	1
+#endif
+
+#ifndef ATTRACTOR_CACHE
+	// true  => the run commands stop as soon as a trial steps onto a cycle they have seen before
+	// false => every trial goes all the way around its cycle.
+	#define ATTRACTOR_CACHE true
+#endif
+
+// 2^16 slots is 768KiB, with a 64KiB filter in front of it. it is only 3/4 full at most,
+// and 8x8 B3/S23 has about 42 thousand states on cycles with a period of at least 32.
+#ifndef ATTRACTOR_BITS
+	#define ATTRACTOR_BITS	16
+#endif
+
+// the shortest cycle that is put in the attractor cache. has to be at least 2.
+#ifndef ATTRACTOR_MIN_PERIOD
+	#define ATTRACTOR_MIN_PERIOD	32
+#endif
+
+// how many steps there are between the attractor cache checks. has to be a power of 2.
+#ifndef ATTRACTOR_STRIDE
+	#define ATTRACTOR_STRIDE	8
+#endif
+
+#ifndef MEMO_CACHE
+	// true  => `run_once` remembers the trials it has run, up to symmetry, and stops as soon
+	//          as it gets to a state whose orbit it has already seen.
+	// false => don't. (see `bnch memo` for whether it is worth it on your machine)
+	#define MEMO_CACHE false
+#endif
+
+// the memo has 2^MEMO_BITS entries of 32 bytes. 16 is 2MiB, so make it fit your L2 or L3.
+#ifndef MEMO_BITS
+	#define MEMO_BITS	16
+#endif
+
+// how many steps there are between the memo lookups.
+#ifndef MEMO_STRIDE
+	#define MEMO_STRIDE	8
+#endif
+
+#ifndef RUNTIME_RULESET
+	// true  => include the -r flag. the kernels check which ruleset to use every step.
+	// false => always use the compiled NEXT_COND.
+	#define RUNTIME_RULESET true
+#endif
+
+#ifndef BENCH
+	// true  => include the bnch command
+	// false => don't.
+	#define BENCH false
+#endif
+
 #ifndef DEBUG
 	// true => print extra collision data when the program exits.
 	// false => don't.
@@ -140,7 +352,6 @@
 	#error "VERSION must be defined"
 #endif
 
-#define     ARENA_MAX (-1 +     ARENA_LEN)
 #define    PERIOD_MAX (-1 +    PERIOD_LEN)
 #define TRANSIENT_MAX (-1 + TRANSIENT_LEN)
 
@@ -231,6 +442,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <fcntl.h> // io.h (_open, _write, ...), O_CREAT, ...
+#include <cpuid.h> // __get_cpuid, for the CPU name in CALIBFILE
 
 
 // EXIT_SUCCESS == 0
@@ -251,8 +463,56 @@ static FILE *stdout = NULL, *stderr = NULL;
 #include "errlog.h"
 #include "windows.h"
 #include "matx8.h"
-#include "matx8-next.h"  // Matx8_next
+#include "matx8-next.h"  // Matx8_next, ruleset
+#include "matx8-simd.h"  // Matx8xN_next
+#if BOARD_SIZE == 8
+	#include "matx8-bitslice.h" // Matx8_nextn_many
+#endif
+#include "board.h"       // Board_next, for the run commands
 #include "table.h"
+#include "cycle.h"       // Cycle_add, for run_once and sim
+
+#if SWEEP && NH_WIDE
+	// every lane uses the 3-bit counters, so it can't run the wide neighborhoods.
+	#pragma message("swep only supports the 3x3 neighborhoods without the center. SWEEP=false")
+	#undef SWEEP
+	#define SWEEP false
+#endif
+
+#if SIMD_RUN && CYCLE_DETECT != CYCLE_TABLE
+	// the lanes only have the plain tables, so `nrun` would ignore CYCLE_DETECT.
+	#pragma message("SIMD_RUN only supports CYCLE_TABLE. SIMD_RUN=false")
+	#undef SIMD_RUN
+	#define SIMD_RUN false
+#endif
+
+#if BOARD_SIZE != 8 && (SWEEP || TAIL || STRAT || BWSEARCH || BENCH || SIMD_RUN || ATTRACTOR_CACHE || MEMO_CACHE)
+	// these are all written for Matx8.
+	#pragma message("swep, tail, nrun strat, bwsr, bwrn, bnch, SIMD_RUN, ATTRACTOR_CACHE, and MEMO_CACHE only support 8x8 boards. turning them off")
+	#undef SWEEP
+	#undef TAIL
+	#undef STRAT
+	#undef BWSEARCH
+	#undef BENCH
+	#undef SIMD_RUN
+	#undef ATTRACTOR_CACHE
+	#undef MEMO_CACHE
+	#define SWEEP		false
+	#define TAIL		false
+	#define STRAT		false
+	#define BWSEARCH	false
+	#define BENCH		false
+	#define SIMD_RUN	false
+	#define ATTRACTOR_CACHE	false
+	#define MEMO_CACHE	false
+#endif
+
+#if INTERLEAVE_RUN && (SIMD_RUN || MEMO_CACHE || CYCLE_DETECT != CYCLE_TABLE || BOARD_SIZE != 8)
+	// SIMD_RUN is used instead, and the rest need `run_once`. it is on by default, so this
+	// doesn't get a message.
+	#undef INTERLEAVE_RUN
+	#define INTERLEAVE_RUN false
+#endif
 
 // 2d 8-bit point
 typedef struct {
@@ -282,7 +542,7 @@ static union {
 } __attribute__((aligned(64))) data = {0};
 
 #if DEBUG
-static u64 max_collisions_state = 0; // the state with the most hash collisions
+static Board max_collisions_state = {0}; // the state with the most hash collisions
 static u32 max_collisions       = 0; // max collisions in a single trial
 // static u64 total_collisions  = 0; // total collisions across all trials
 #endif
@@ -306,7 +566,7 @@ static struct {
 		char array[2];
 	} sim_chars;
 
-	bool file_out, bell, silent, quiet; // 4 bytes
+	bool file_out, traj_out, bell, silent, quiet, calibrate; // 6 bytes
 #if CLIPBOARD
 	bool clip;                          // 1 byte
 #endif
@@ -329,9 +589,23 @@ static const char *const help_string =
 	"\n    -c   in run modes, copy the summary to the clipboard as well as printing."
 #endif
 	"\n    -f   in run modes, concatenate the summary data together into " DATAFILE "."
+#if COUNTER_RAND
+	"\n    -g   seed the random start states with SEED or SEED:FIRST, to start at trial FIRST."
+	"\n         the same seed always gives the same trials, so `-g S:I run` runs trial I again."
+	"\n    -p   in `nrun`, take the trials from the next ones of the seed (0 without -g) that no"
+	"\n         other run has taken, from " PERMFILE ". so no two runs ever repeat a start state."
+#endif
 	"\n    -R   use REALTIME process priority class and lock to the given CPU cores."
 	"\n         the argument can either be a hex core mask or a core list like \"1,2,3\"."
 	"\n    -H   use HIGH process priority class."
+#if RUNTIME_RULESET
+	"\n    -r   use the given outer-totalistic ruleset instead of the compiled one, e.g. `-r B36/S23`."
+#if NH_COUNT > 9
+	"\n         the neighborhood can have more than 9 neighbors, so separate the counts with commas."
+#endif
+#endif
+	"\n    -t   in run modes, append the whole trajectory of every logged trial to " TRAJFILE "."
+	"\n         it does nothing with -q, since nothing is logged then."
 	"\n    -q   quiet mode. suppresses most non-error output messages."
 	"\n    -Q   silent mode. suppresses all terminal output including error messages."
 	"\n    -s   specify a key code to stop in applicable modes"
@@ -340,6 +614,9 @@ static const char *const help_string =
 	"\n    -T   specify a wait in ms between trials in sim modes. default=" TOSTRING_EXPANDED(SLEEP_MS_T_DEF) "."
 	"\n    -v   print the version string and exit."
 	"\n    -h, -?, --help   print this message and exit"
+	"\n    --calibrate      time the table size, random buffer length, and batch width on this"
+	"\n                     machine and save the fastest ones to " CALIBFILE ", which every run"
+	"\n                     loads. if a command is given, it runs afterwards with them."
 	"\n"
 	"\n    key codes for -s and -u can be an integer or a string. integer codes are here:"
 	"\n     - https://learn.microsoft.com/en-us/windows/win32/inputdev/virtual-key-codes"
@@ -358,16 +635,62 @@ static const char *const help_string =
 	"\n    help           alias of `-h` flag"
 	"\n    run [S...]     runs simulations on given states and returns data histograms"
 	"\n    nrun [N]       runs N random trials and returns data histograms"
+	"\n    nrun until E [X...]  runs random trials until the confidence interval of every X is"
+	"\n                   within a relative E. X is empty, const, cycle, pN (period N), or tN"
+	"\n                   (transient N), and defaults to the three counts. e.g. `nrun until 0.01 p132`"
+	"\n                   stops after UNTIL_MAX trials, and saves every TIMER_PERIOD with `-f`"
+#if STRAT
+	"\n    nrun strat N   runs about N random trials stratified by the population of the start state,"
+	"\n                   with a Neyman allocation from a pilot, and returns the reweighted histograms"
+#endif
+#if BOARD_SIZE == 8
 	"\n    sim [S...]     runs simulations visually on all given states"
 	"\n    nsim [N]       runs N random trials and shows them visually"
 	"\n    sim1 [S]       traverse the given state until the stop key is pressed"
+#endif
 	"\n    step S [N]     step to the next states N times and print out the result"
+#if BOARD_SIZE == 8
+	"\n    mstp N S...    step every given state N times, 64 at a time (bit-sliced)"
+	"\n    infr S S...    list every ruleset that steps each given state to the next one"
+#endif
+#if CENSUS
+	"\n    cens W [H]     runs every state of a W by H torus (H defaults to W, both 4 to 6)"
+	"\n                   and returns the exact histograms, including the in-degrees."
+	"\n                   in-degree 0 is the number of garden of eden states."
+#endif
+#if TAIL
+	"\n    tail K [N]     estimates P(transient > K) for rare K with subset simulation, with N"
+	"\n                   start states for each level (default " TOSTRING_EXPANDED(TAIL_N) "). it only helps when the"
+	"\n                   chains mix. for B3/S23 on 8x8 it takes 2-4 times the trials nrun does for the"
+	"\n                   same error at K = 150-250. -q only prints the estimate, its SE, and the trials."
+#endif
+#if SWEEP
+	"\n    swep N R...    runs N random trials for each ruleset R and returns data histograms"
+	"\n                   for each one. R can be `B.../S...`, a truth table, or a range of"
+	"\n                   truth tables like 0x0800-0x08ff. color dual pairs are run once."
+#endif
 #if BWSEARCH
 	"\n    bwsr S [N]     backwards search to find all Nth-generation ancestors to a given state"
 	"\n    bwrn [N]       runs N random trials on predecessor searches and count results"
 #endif
 	"\n    tfm S T [X Y]  apply a transformation (T) and an optional translation (X, Y)."
 	"\n                   options for T are given below. T happens before X and Y"
+#if BENCH
+	"\n    bnch B [N]     run benchmark B with N inputs (default 1,000,000). options for B:"
+	"\n                   run: scalar run_once vs the interleaved and multi-board engines"
+	"\n                   cycle: trials/sec and memory of each cycle detector for run_once"
+#if MEMO_CACHE
+	"\n                   memo: run_once without and with the memo, and its hit rate"
+#endif
+	"\n                   step: 64 generations of Matx8_next vs the bit-sliced engine"
+#if !NH_WIDE
+	"\n                   lut: bitwise kernel vs row table kernel for each neighborhood"
+	"\n                   gen: serial vs carry-save adder neighbor counter"
+#if RUNTIME_RULESET
+	"\n                   rule: ruleset fast paths vs the truth table evaluation for -r"
+#endif
+#endif
+#endif
 	"\n"
 	"\n    dump           runs `./" PY_BASE ".py -s " DATAFILE "` and exit"
 	"\n    fold           runs `./" PY_BASE ".py -f " DATAFILE "` and exit"
@@ -376,6 +699,11 @@ static const char *const help_string =
 	"\n"
 	"\n    N always defaults to 1 if not given."
 	"\n    S defaults to a random state if optional and not given."
+#if BOARD_SIZE != 8
+	"\n    S is given in hex, with row 0 in the lowest bits. missing leading digits are zeros."
+	"\n    run and nrun stop traversing when a repeat state is found."
+	"\n    'inf' can be given to nrun to make it run until the stop key is given."
+#else
 	"\n    run, nrun, sim, and nsim stop traversing when a repeat state is found."
 	"\n    'inf' can be given to nrun"
 #if BWSEARCH
@@ -384,29 +712,69 @@ static const char *const help_string =
 	" and nsim"
 #endif
 	" to make them run until the stop key is given."
+#endif
 	"\n"
 	"\nbuild config:"
-	"\n    NEIGHBORHOOD="
-	#if NEIGHBORHOOD == NH_MOORE
-		"MOORE"
-	#elif NEIGHBORHOOD == NH_VON_NEUMANN
-		"VON_NEUMANN"
-	#elif NEIGHBORHOOD == NH_DIAGONAL
-		"DIAGONAL"
+	"\n    NEIGHBORHOOD="	NH_NAME
+	"\n    NH_CENTER="		TOSTRING_EXPANDED(NH_CENTER)
+	"\n    BOARD_SIZE="		TOSTRING_EXPANDED(BOARD_SIZE)
+	"\n    KERNEL="
+	#if KERNEL == KERNEL_LUT
+		"LUT"
+	#else
+		"BITWISE"
 	#endif
 	#ifdef ISA // the profiling version doesn't always have this
 	"\n    ISA=\""			ISA "\""
 	#endif
+	"\n    CYCLE_DETECT="
+	#if CYCLE_DETECT == CYCLE_BRENT
+		"BRENT"
+	#elif CYCLE_DETECT == CYCLE_NIVASCH
+		"NIVASCH"
+	#elif CYCLE_DETECT == CYCLE_SYMMETRY
+		"SYMMETRY"
+	#else
+		"TABLE"
+	#endif
 	"\n    RULESET=\""		RULESET "\""
-	"\n    TABLE_BITS="		TOSTRING_EXPANDED(TABLE_BITS)
+	"\n    TABLE_BITS="		TOSTRING_EXPANDED(TABLE_BITS) " (max=" TOSTRING_EXPANDED(TABLE_BITS_MAX) ")"
 	"\n    PERIOD_LEN="		TOSTRING_EXPANDED(PERIOD_LEN)
 	"\n    TRANSIENT_LEN="	TOSTRING_EXPANDED(TRANSIENT_LEN)
-	#if RAND_BUF_LEN == 1
+	"\n    LOG_TRANSIENT="	TOSTRING_EXPANDED(LOG_TRANSIENT)
+	"\n    LOG_PERIOD="		TOSTRING_EXPANDED(LOG_PERIOD)
+	"\n    STEP_MAX="		TOSTRING_EXPANDED(STEP_MAX)
+	#if COUNTER_RAND
+	"\n    RAND=\"counter-based splitmix64\""
+	#elif RAND_BUF_LEN == 1
 	"\n    RAND=\"RDRAND, unbuffered\""
 	#else
 	"\n    RAND=\"RtlGenRandom, buffer=" TOSTRING_EXPANDED(RAND_BUF_LEN) "\""
 	#endif
-	"\n    ARENA_LEN="		TOSTRING_EXPANDED(ARENA_LEN)
+	"\n    RUNTIME_RULESET="	TOSTRING_EXPANDED(RUNTIME_RULESET)
+	"\n    TAIL="			TOSTRING_EXPANDED(TAIL)
+	"\n    STRAT="			TOSTRING_EXPANDED(STRAT)
+	"\n    CENSUS="			TOSTRING_EXPANDED(CENSUS)
+	#if CENSUS
+	" (threads=" TOSTRING_EXPANDED(CENSUS_THREADS) ")"
+	#endif
+	"\n    SIMD_RUN="		TOSTRING_EXPANDED(SIMD_RUN)
+	#if SIMD_RUN
+	" (lanes=" TOSTRING_EXPANDED(SIMD_LANES) ")"
+	#endif
+	"\n    INTERLEAVE_RUN="	TOSTRING_EXPANDED(INTERLEAVE_RUN)
+	#if INTERLEAVE_RUN
+	" (max width=" TOSTRING_EXPANDED(INTERLEAVE_K) ", default width=" TOSTRING_EXPANDED(INTERLEAVE_WIDTH) ")"
+	#endif
+	"\n    ATTRACTOR_CACHE="	TOSTRING_EXPANDED(ATTRACTOR_CACHE)
+	#if ATTRACTOR_CACHE
+	" (bits=" TOSTRING_EXPANDED(ATTRACTOR_BITS) ", min period=" TOSTRING_EXPANDED(ATTRACTOR_MIN_PERIOD)
+		", stride=" TOSTRING_EXPANDED(ATTRACTOR_STRIDE) ")"
+	#endif
+	"\n    MEMO_CACHE="		TOSTRING_EXPANDED(MEMO_CACHE)
+	#if MEMO_CACHE
+	" (bits=" TOSTRING_EXPANDED(MEMO_BITS) ", stride=" TOSTRING_EXPANDED(MEMO_STRIDE) ")"
+	#endif
 	"\n    CLIPBOARD="		TOSTRING_EXPANDED(CLIPBOARD)
 	"\n    DEBUG="			TOSTRING_EXPANDED(DEBUG)
 	"\n"
@@ -422,10 +790,14 @@ static const char *const help_string =
 	"\nstate interest bit meanings (for run modes):"
 	"\n    7  end state is not empty and is a perfect inverse of the start state"
 	"\n    6  end state is not empty. start and end states together total the board"
+#if BOARD_SIZE == 8
 	"\n    5  constant end state with a number of alive bits in (26, 32)"
+#else
+	"\n    5  constant end state with between 13/32 and 1/2 of the cells alive"
+#endif
 	"\n    4  new period value"
 	"\n    3  new transient value"
-	"\n    2  period > 36 and transient - period > 196"
+	"\n    2  period > " TOSTRING_EXPANDED(LOG_PERIOD) " and transient - period > " TOSTRING_EXPANDED(LOG_TRANSIENT)
 	"\n    1  2nd or 3rd encounter of a particular period"
 	"\n    0  2nd or 3rd encounter of a particular transient length"
 	"\n"
@@ -449,19 +821,26 @@ static FORCE_INLINE void print_table_headers(void) {
 	if (cfg.quiet)
 		return;
 
-#if INT_LEN(PERIOD_LEN) == 3 && INT_LEN(TRANSIENT_LEN) == 3
+#if COUNTER_RAND
+	// the trial numbers can only be run again with the seed, so print it if it was random.
+	unlikely_if (!rng.seeded)
+		printf("seed: %zu\n", rng.seed);
+#endif
+
+#if INT_LEN(PERIOD_LEN) == 3 && INT_LEN(TRANSIENT_LEN) == 3 && BOARD_SIZE == 8
 	printf(
 		"timestamp        | start state        | int | per | trs | n | trial\n"
 		"--------------------------------------------------------------------"
 	);
 #else
+	// the start state column is as wide as the hex string for the board.
 	printf(
-		"timestamp        | start state        | int | %*s | %*s | n | trial\n"
+		"timestamp        | %-*s | int | %*s | %*s | n | trial\n"
 		"--------------------------------------------------------------------",
-		INT_LEN(PERIOD_LEN), "per", INT_LEN(TRANSIENT_LEN), "trs"
+		BOARD_STR_LEN - 1, "start state", INT_LEN(PERIOD_LEN), "per", INT_LEN(TRANSIENT_LEN), "trs"
 	);
 
-	for (u8 i = 0; i < max(INT_LEN(PERIOD_LEN), 3) + max(INT_LEN(TRANSIENT_LEN), 3) - 6; i++)
+	for (u16 i = 0; i < max(INT_LEN(PERIOD_LEN), 3) + max(INT_LEN(TRANSIENT_LEN), 3) - 6 + BOARD_STR_LEN - 19; i++)
 		putchar('-');
 #endif
 }
@@ -472,13 +851,53 @@ static void bell(void) { likely_if (!cfg.silent) putchar('\x07'); }
 #include "du64.h"
 #include "summary.h"
 #include "sim.h"
+
+#if ATTRACTOR_CACHE
+	#include "attractor.h" // Attractor_period, for run_once and run-simd.h
+#endif
+
+#if MEMO_CACHE
+	#include "memo.h"      // Memo_get, for run_once
+#endif
+
+#if COUNTER_RAND
+	#include "claim.h"     // Claim_trials, for `-p`
+#endif
+
+#include "trajectory.h"  // Trajectory_write, for `-t`
 #include "run.h"
+#include "until.h"
+
+#if STRAT
+	#include "strat.h"
+#endif
+#include "calibrate.h"
+
+#if BOARD_SIZE == 8
+	#include "infer.h"
+#endif
+
+#if SWEEP
+	#include "sweep.h"
+#endif
+
+#if CENSUS
+	#include "census.h"
+#endif
+
+#if TAIL
+	#include "tail.h"
+#endif
 
 #if BWSEARCH
 	#include "bw-search.h"
 	#include "bw-run.h"
 #endif
 
+#if BENCH
+	#include "bench.h"
+#endif
+
 #define SUMMARY_IMPL
 #include "summary.h"
 
@@ -487,8 +906,11 @@ static void log_collisions(void) {
 	if (cfg.quiet || total_collisions == 0)
 		return;
 
+	char state[BOARD_STR_LEN];
+	Board_sprint(state, max_collisions_state);
+
 	printf("hash collisions: total="); print_du64(total_collisions, '_');
-	printf(", trial max=%u, s=%#018zx\n", max_collisions, max_collisions_state);
+	printf(", trial max=%u, s=%s\n", max_collisions, state);
 }
 #endif
 
@@ -511,10 +933,15 @@ static FORCE_INLINE bool parse_flags(u32 *const restrict pargc, char **restrict
 		full_flag = POP_ARG();
 		flag = full_flag + 1; // first argument, but skip the dash.
 
-		// --help is the only flag that can be more than one character
+		// --help and --calibrate are the only flags that can be more than one character
 		if (streq(flag, "-help"))
 			goto help_flag;
 
+		if (streq(flag, "-calibrate")) {
+			cfg.calibrate = true;
+			continue;
+		}
+
 		fc = *flag; // flag character
 
 		if (fc == '\0')
@@ -534,6 +961,7 @@ static FORCE_INLINE bool parse_flags(u32 *const restrict pargc, char **restrict
 			case 'q': cfg.quiet    = true; break;
 			case 'b': cfg.bell     = true; break;
 			case 'f': cfg.file_out = true; break;
+			case 't': cfg.traj_out = true; break;
 			#if CLIPBOARD
 			case 'c': cfg.clip     = true; break;
 			#endif
@@ -699,6 +1127,50 @@ static FORCE_INLINE bool parse_flags(u32 *const restrict pargc, char **restrict
 			case 'H':
 				SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS);
 				break;
+			#if COUNTER_RAND
+			case 'g': {
+				if (operand == NULL)
+					goto flag_no_operand;
+
+				char *arg_end;
+				rng.seed  = strtoull(operand, &arg_end, 0);
+				rng.first = 0;
+
+				if (*arg_end == ':' && arg_end[1] != '\0')
+					rng.first = strtoull(arg_end + 1, &arg_end, 0);
+
+				if (*arg_end != '\0' || arg_end == operand)
+					goto flag_invalid_operand;
+
+				rng.seeded = true;
+				POP_ARG();
+				break;
+			}
+			case 'p':
+				claims.permute = true;
+				rng.seeded     = true; // so the summary has the ranges
+				break;
+			#endif
+			#if RUNTIME_RULESET
+			case 'r': {
+				if (operand == NULL)
+					goto flag_no_operand;
+
+				RulesetTT tt;
+				const char *const error = Ruleset_parse(&tt, operand);
+
+				unlikely_if (error != NULL) {
+					eprintf("flag `-%c` (in `%s`) given with an invalid ruleset `%s`: %s\n",
+						*flag, full_flag, operand, error);
+					exit(EXIT_FLG_INVOP);
+				}
+
+				Ruleset_set(NULL, tt); // normalized, so data.json objects compare equal
+				ruleset.given = true;
+				POP_ARG();
+				break;
+			}
+			#endif
 			case 'h': FALLTHROUGH;
 			case '?':
 				goto help_flag;
@@ -783,6 +1255,37 @@ static Matx8 Matx8_tryparse(
 	return (Matx8) {.matx = state};
 }
 
+static Board Board_tryparse(
+	char *restrict *restrict argv,
+	const char *const restrict cmd,
+	const u8 pos
+) {
+#if BOARD_SIZE == 8
+	return Matx8_tryparse(argv, cmd, pos);
+#else
+	// the bigger boards don't fit in an integer, so they are only given in hex.
+	// the last digit is the lowest 4 cells of row 0, the same as with Matx8_tryparse.
+	const char *str = argv[pos], *end;
+
+	if (str[0] == '0' && (str[1] | 32) == 'x')
+		str += 2;
+
+	for (end = str; *end >= '0' && *end <= '9' || (*end | 32) >= 'a' && (*end | 32) <= 'f'; end++);
+
+	if (*end != '\0' || end == str || end - str > BOARD_CELLS/4)
+		cmd_invalid_operand(cmd, pos);
+
+	Board state = {0};
+
+	for (u16 i = 0; end --> str; i++) {
+		const u8 digit = *end <= '9' ? *end - '0' : (*end | 32) - 'a' + 10;
+		state.words[i / 16] |= (u64) digit << (i % 16 * 4);
+	}
+
+	return state;
+#endif
+}
+
 #if SHELL32
 void init_crt(void);
 #else
@@ -827,8 +1330,8 @@ void mainCRTStartup(void)
 	do { // do while false
 		const bool flags_given = parse_flags(&argc, &argv);
 
-		if (argc != 0)
-			// there are more arguments left
+		if (argc != 0 || cfg.calibrate)
+			// there are more arguments left, or `--calibrate` is the command
 			break;
 
 		// example: `./life` should print the help text, but `./life -H` shouldn't
@@ -848,6 +1351,34 @@ void mainCRTStartup(void)
 		}
 	} while (false);
 
+	likely_if (!ruleset.given)
+		Ruleset_set(RULESET, Ruleset_compiled_tt());
+
+#if KERNEL == KERNEL_LUT
+	Matx8_lut_init_default();
+#endif
+
+#if BOARD_SIZE == 8
+	Symmetry_init();
+#endif
+
+#if COUNTER_RAND
+	likely_if (!rng.seeded)
+		RtlGenRandom(&rng.seed, sizeof rng.seed);
+
+	Rand_seed(rng.seed, rng.first * RAND_WORDS);
+	claims.first = rng.first;
+#endif
+
+	if (cfg.calibrate) {
+		calibrate();
+
+		if (argc == 0)
+			exit(EXIT_SUCCESS);
+	}
+	else
+		Calibrate_load();
+
 	if (_isatty(1) && likely(!cfg.silent)) {
 		printf("\e[0m\e[?25l"); // remove terminal styling if there is any and hide the cursor.
 		atexit(&show_cursor);
@@ -882,6 +1413,50 @@ void mainCRTStartup(void)
 	case CHARS4_TO_U32('n', 'r', 'u', 'n'):
 		print_table_headers();
 
+		unlikely_if (argc >= 3 && streq(argv[1], "until")) {
+			char *end;
+			const double target = strtod(argv[2], &end);
+
+			unlikely_if (*end != '\0' || !(target > 0 && target < 1)) {
+				eprintf("command `%s` given an invalid precision `%s`. it has to be between 0 and 1.\n", "nrun", argv[2]);
+				exit(EXIT_CMD_INVOP);
+			}
+
+			UntilStat stats[3] = {
+				{.kind = UNTIL_COUNT, .value = EMPTY},
+				{.kind = UNTIL_COUNT, .value = CONST},
+				{.kind = UNTIL_COUNT, .value = CYCLE},
+			};
+
+			UntilStat *const pstats = argc > 3 ? malloc((argc - 3) * sizeof(UntilStat)) : stats;
+			OOM(pstats, 16);
+
+			for (u32 i = 3; i < argc; i++) {
+				unlikely_if (!Until_parse(pstats + i - 3, argv[i])) {
+					eprintf("command `%s` given an invalid statistic `%s`.\n", "nrun", argv[i]);
+					exit(EXIT_CMD_INVOP);
+				}
+			}
+
+			run_until(target, pstats, argc > 3 ? argc - 3 : 3);
+			give_summary(SUM_NO_RETURN);
+			__builtin_unreachable();
+		}
+
+	#if STRAT
+		unlikely_if (argc == 3 && streq(argv[1], "strat")) {
+			n = Matx8_tryparse(argv, "nrun", 2).matx;
+
+			// the pilot needs enough trials to have one in every stratum.
+			unlikely_if (n < STRAT_PILOT * STRAT_LEN)
+				cmd_invalid_operand("nrun", 2);
+
+			strat_run(n);
+			give_summary(SUM_NO_RETURN);
+			__builtin_unreachable();
+		}
+	#endif
+
 		likely_if (argc == 2) {
 			likely_if (streq(argv[1], "inf")) {
 				run_forever();
@@ -898,11 +1473,27 @@ void mainCRTStartup(void)
 			exit(EXIT_CMD_INVOP);
 		}
 
-		for (u8 i = 0; i < (n & 7); i++)
-			run_once();
+	#if COUNTER_RAND
+		unlikely_if (claims.permute)
+			Claim_jump(Claim_trials(n));
+	#endif
+
+	#if SIMD_RUN
+		simd_run(n);
+	#else
+	#if INTERLEAVE_RUN
+		if (tune.width > 1)
+			ilv_run(n);
+		else
+	#endif
+		{
+			for (u8 i = 0; i < (n & 7); i++)
+				run_once();
 
-		for (u64 i = n >> 3; i --> 0 ;)
-			RUN_8();
+			for (u64 i = n >> 3; i --> 0 ;)
+				RUN_8();
+		}
+	#endif
 
 		give_summary(SUM_NO_RETURN);
 		__builtin_unreachable();
@@ -915,10 +1506,10 @@ void mainCRTStartup(void)
 			// run once for each state given
 			for (u32 i = 1; i < argc; i++) {
 				if (cfg.silent)
-					run_once(Matx8_tryparse(argv, "run", i));
+					run_once(Board_tryparse(argv, "run", i));
 				else {
 					putchar('\n');
-					Matx8 state = Matx8_tryparse(argv, "run", i);
+					Board state = Board_tryparse(argv, "run", i);
 					printf("\e[A");
 					run_once(state);
 				}
@@ -926,6 +1517,7 @@ void mainCRTStartup(void)
 
 		give_summary(SUM_NO_RETURN);
 		__builtin_unreachable();
+#if BOARD_SIZE == 8
 	case CHARS4_TO_U32('s', 'i', 'm',  0 ):
 		unlikely_if (argc == 1) {
 			cli_sim(1);
@@ -1004,13 +1596,14 @@ void mainCRTStartup(void)
 			putchar('\n');
 		#endif
 		break;
+#endif
 	case CHARS4_TO_U32('s', 't', 'e', 'p'): {
 		unlikely_if (argc < 2 && argc > 3) {
 			eprintf("command `%s` expected %s operands, found %u.\n", "step", "1 or 2", argc - 1);
 			exit(EXIT_CMD_INVOP);
 		}
 
-		Matx8 state = Matx8_tryparse(argv, "step", 1);
+		Board state = Board_tryparse(argv, "step", 1);
 
 		if (argc == 2)
 			n = 1;
@@ -1028,13 +1621,15 @@ void mainCRTStartup(void)
 
 			u32 p, t;
 
-			for (p = 0; data.periods[p] == 0; p++)
-				if (p >= PERIOD_MAX)
-					__builtin_unreachable();
+			// the one trial is either in `data` or in the long histograms.
+			for (p = 0; p < PERIOD_LEN && data.periods[p] == 0; p++);
+			for (t = 0; t < TRANSIENT_LEN && data.transients[t] == 0; t++);
 
-			for (t = 0; data.transients[t] == 0; t++)
-				if (t >= TRANSIENT_MAX)
-					__builtin_unreachable();
+			unlikely_if (p == PERIOD_LEN)
+				p = long_periods.list[0].key;
+
+			unlikely_if (t == TRANSIENT_LEN)
+				t = long_transients.list[0].key;
 
 			n -= t;
 			t -= p;
@@ -1042,14 +1637,17 @@ void mainCRTStartup(void)
 
 			// iterate until it starts repeating
 			while (t --> 0)
-				state = Matx8_next(state);
+				state = Board_next(state);
 		}
 
 		while (n --> 0)
-			state = Matx8_next(state);
+			state = Board_next(state);
 
-		likely_if (!cfg.silent)
-			printf("%#018zx\n", state.matx);
+		likely_if (!cfg.silent) {
+			char buf[BOARD_STR_LEN];
+			Board_sprint(buf, state);
+			puts(buf);
+		}
 
 		if (!cfg.quiet) {
 			print_state(state);
@@ -1058,6 +1656,137 @@ void mainCRTStartup(void)
 
 		break;
 	}
+#if BOARD_SIZE == 8
+	case CHARS4_TO_U32('m', 's', 't', 'p'): {
+		unlikely_if (argc < 3) {
+			eprintf("command `%s` expected %s operands, found %u.\n", "mstp", "at least 2", argc - 1);
+			exit(EXIT_CMD_INVOP);
+		}
+
+		n = Matx8_tryparse(argv, "mstp", 1).matx;
+
+		const u32 count = argc - 2;
+		Matx8 *const states = malloc(count * sizeof(Matx8));
+		OOM(states, 6);
+
+		for (u32 i = 0; i < count; i++)
+			states[i] = Matx8_tryparse(argv, "mstp", i + 2);
+
+		Matx8_nextn_many(states, count, n);
+
+		for (u32 i = 0; i < count; i++) {
+			likely_if (!cfg.silent)
+				printf("%#018zx\n", states[i].matx);
+
+			if (!cfg.quiet) {
+				print_state(states[i]);
+				putchar('\n');
+			}
+		}
+
+		free(states);
+		break;
+	}
+	case CHARS4_TO_U32('i', 'n', 'f', 'r'): {
+		unlikely_if (argc < 3) {
+			eprintf("command `%s` expected %s operands, found %u.\n", "infr", "at least 2", argc - 1);
+			exit(EXIT_CMD_INVOP);
+		}
+
+		const u32 count = argc - 1;
+		Matx8 *const states = malloc(count * sizeof(Matx8));
+		OOM(states, 9);
+
+		for (u32 i = 0; i < count; i++)
+			states[i] = Matx8_tryparse(argv, "infr", i + 1);
+
+		infer_print(states, count);
+
+		free(states);
+		break;
+	}
+#endif
+#if CENSUS
+	case CHARS4_TO_U32('c', 'e', 'n', 's'): {
+		unlikely_if (argc < 2 || argc > 3) {
+			eprintf("command `%s` expected %s operands, found %u.\n", "cens", "1 or 2", argc - 1);
+			exit(EXIT_CMD_INVOP);
+		}
+
+		const u64 w = Matx8_tryparse(argv, "cens", 1).matx;
+		const u64 h = argc == 2 ? w : Matx8_tryparse(argv, "cens", 2).matx;
+
+		unlikely_if (w < CENSUS_MIN || w > CENSUS_MAX)
+			cmd_invalid_operand("cens", 1);
+
+		unlikely_if (h < CENSUS_MIN || h > CENSUS_MAX)
+			cmd_invalid_operand("cens", 2);
+
+		census_run(w, h);
+		break;
+	}
+#endif
+#if TAIL
+	case CHARS4_TO_U32('t', 'a', 'i', 'l'): {
+		unlikely_if (argc < 2 || argc > 3) {
+			eprintf("command `%s` expected %s operands, found %u.\n", "tail", "1 or 2", argc - 1);
+			exit(EXIT_CMD_INVOP);
+		}
+
+		const u64 k = Matx8_tryparse(argv, "tail", 1).matx;
+		n = argc == 2 ? TAIL_N : Matx8_tryparse(argv, "tail", 2).matx;
+
+		unlikely_if (k >= STEP_MAX)
+			cmd_invalid_operand("tail", 1);
+
+		// fewer than 1/TAIL_P0 samples wouldn't have anything to start the next level from.
+		unlikely_if (n < 100 || n > UINT32_MAX)
+			cmd_invalid_operand("tail", 2);
+
+		tail_run(k, n);
+		break;
+	}
+#endif
+#if SWEEP
+	case CHARS4_TO_U32('s', 'w', 'e', 'p'): {
+		unlikely_if (argc < 3) {
+			eprintf("command `%s` expected %s operands, found %u.\n", "swep", "at least 2", argc - 1);
+			exit(EXIT_CMD_INVOP);
+		}
+
+		n = Matx8_tryparse(argv, "swep", 1).matx;
+
+		unlikely_if (n == 0)
+			cmd_invalid_operand("swep", 1);
+
+		// each ruleset is only added once, so there are at most 2^16 of them.
+		u16 *const list = malloc((1 << 16) * sizeof(u16));
+		OOM(list, 7);
+
+		u32 count = 0;
+
+		for (u32 i = 2; i < argc; i++) {
+			const char *const error = sweep_add(list, &count, argv[i]);
+
+			unlikely_if (error != NULL) {
+				eprintf("command `%s` given with an invalid ruleset `%s` at position %u: %s\n",
+					"swep", argv[i], i, error);
+				exit(EXIT_CMD_INVOP);
+			}
+		}
+
+		SweepRule *const rules = malloc(count * sizeof(SweepRule));
+		OOM(rules, 8);
+
+		count = sweep_pair(rules, list, count);
+		free(list);
+
+		sweep_run(rules, count, n);
+
+		free(rules);
+		break;
+	}
+#endif
 #if BWSEARCH
 	case CHARS4_TO_U32('b', 'u', 's',  0 ): FALLTHROUGH;
 	case CHARS4_TO_U32('b', 'w', 's', 'r'): {
@@ -1125,7 +1854,7 @@ void mainCRTStartup(void)
 			exit(EXIT_CMD_INVOP);
 		}
 
-		Matx8 state = Matx8_tryparse(argv, "tfm", 1);
+		Board state = Board_tryparse(argv, "tfm", 1);
 		const u64 tfm = Matx8_tryparse(argv, "tfm", 2).matx;
 
 		if (tfm >= sizeof(tfm_strs) / sizeof(*tfm_strs))
@@ -1137,20 +1866,21 @@ void mainCRTStartup(void)
 			roll = (Point8) {0};
 		else {
 			u64 tmp = Matx8_tryparse(argv, "tfm", 3).matx;
-			if (tmp > 7) cmd_invalid_operand("tfm", 3);
+			if (tmp >= BOARD_SIZE) cmd_invalid_operand("tfm", 3);
 			roll.x = tmp;
 
 			tmp = Matx8_tryparse(argv, "tfm", 4).matx;
-			if (tmp > 7) cmd_invalid_operand("tfm", 4);
+			if (tmp >= BOARD_SIZE) cmd_invalid_operand("tfm", 4);
 			roll.y = tmp;
 		}
 
-		state = Matx8_tfm(state, tfm);
-		state = Matx8_xroll(state, roll.x);
-		state = Matx8_yroll(state, roll.y);
+		state = Board_tfm(state, tfm, roll.x, roll.y);
 
-		likely_if (!cfg.silent)
-			printf("%#018zx\n", state.matx);
+		likely_if (!cfg.silent) {
+			char buf[BOARD_STR_LEN];
+			Board_sprint(buf, state);
+			puts(buf);
+		}
 
 		if (!cfg.quiet) {
 			print_state(state);
@@ -1158,6 +1888,41 @@ void mainCRTStartup(void)
 		}
 		break;
 	}
+#if BENCH
+	case CHARS4_TO_U32('b', 'n', 'c', 'h'): {
+		unlikely_if (argc < 2 || argc > 3) {
+			eprintf("command `%s` expected %s operands, found %u.\n", "bnch", "1 or 2", argc - 1);
+			exit(EXIT_CMD_INVOP);
+		}
+
+		n = argc == 2 ? 1'000'000 : Matx8_tryparse(argv, "bnch", 2).matx;
+
+		if (streq(argv[1], "run"))
+			bench_run(n);
+		else if (streq(argv[1], "cycle"))
+			bench_cycle(n);
+	#if MEMO_CACHE
+		else if (streq(argv[1], "memo"))
+			bench_memo(n);
+	#endif
+		else if (streq(argv[1], "step"))
+			bench_step(n);
+	#if !NH_WIDE
+		else if (streq(argv[1], "lut"))
+			bench_lut(n);
+		else if (streq(argv[1], "gen"))
+			bench_gen(n);
+	#if RUNTIME_RULESET
+		else if (streq(argv[1], "rule"))
+			bench_rule(n);
+	#endif
+	#endif
+		else
+			cmd_invalid_operand("bnch", 1);
+
+		break;
+	}
+#endif
 	case CHARS4_TO_U32('d', 'u', 'm', 'p'):
 		exit(system(PY_BASE " -s " DATAFILE));
 		__builtin_unreachable();